@@ -0,0 +1,189 @@
+#include "Scanner.h"
+
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Scanner::Scanner(const string &path)
+    : m_data(nullptr), m_size(0), m_pos(nullptr), m_end(nullptr) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0) {
+        if (info.st_size == 0) {
+            // An empty file can't be mapped, but reads as having no data
+            m_data = "";
+        } else {
+            void *map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE,
+                    fd, 0);
+            if (map != MAP_FAILED) {
+                madvise(map, info.st_size, MADV_SEQUENTIAL);
+                m_data = static_cast<const char *>(map);
+                m_size = info.st_size;
+            }
+        }
+    }
+    close(fd);
+
+    m_pos = m_data;
+    m_end = m_data == nullptr ? nullptr : m_data + m_size;
+}
+
+Scanner::~Scanner() {
+    if (m_size > 0) {
+        munmap(const_cast<char *>(m_data), m_size);
+    }
+}
+
+bool Scanner::valid() const {
+    return m_data != nullptr;
+}
+
+void Scanner::skipSpace() {
+    while (m_pos != m_end && (*m_pos == ' ' || *m_pos == '\n'
+            || *m_pos == '\t' || *m_pos == '\r')) {
+        m_pos++;
+    }
+}
+
+bool Scanner::atEnd() {
+    skipSpace();
+    return m_pos == m_end;
+}
+
+char Scanner::peek() {
+    skipSpace();
+    return m_pos == m_end ? '\0' : *m_pos;
+}
+
+bool Scanner::readInt(int &out) {
+    skipSpace();
+    const char *p = m_pos;
+    bool negative = p != m_end && *p == '-';
+    if (p != m_end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+
+    // Values outside the range of int are rejected rather than wrapped
+    long long limit = negative ? -static_cast<long long>(INT_MIN) : INT_MAX;
+    const char *digits = p;
+    long long value = 0;
+    while (p != m_end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        if (value > limit) {
+            return false;
+        }
+        p++;
+    }
+    if (p == digits) {
+        return false;
+    }
+
+    out = negative ? -value : value;
+    m_pos = p;
+    return true;
+}
+
+// Numbers whose digits fit a double's mantissa and whose decimal exponent is
+// small are converted exactly with a single multiplication or division.
+// Anything else goes through strtod.
+bool Scanner::readDouble(double &out) {
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    skipSpace();
+    const char *p = m_pos;
+    bool negative = p != m_end && *p == '-';
+    if (p != m_end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    bool truncated = false;
+    while (p != m_end && *p >= '0' && *p <= '9') {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        } else {
+            exponent++;
+            truncated = true;
+        }
+        any = true;
+        p++;
+    }
+    if (p != m_end && *p == '.') {
+        p++;
+        while (p != m_end && *p >= '0' && *p <= '9') {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            } else {
+                truncated = true;
+            }
+            any = true;
+            p++;
+        }
+    }
+    if (!any) {
+        return false;
+    }
+    if (p != m_end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        bool exp_negative = q != m_end && *q == '-';
+        if (q != m_end && (*q == '-' || *q == '+')) {
+            q++;
+        }
+        int value = 0;
+        const char *exp_digits = q;
+        while (q != m_end && *q >= '0' && *q <= '9') {
+            value = value < 10000 ? value * 10 + (*q - '0') : value;
+            q++;
+        }
+        if (q != exp_digits) {
+            exponent += exp_negative ? -value : value;
+            p = q;
+        }
+    }
+
+    if (!truncated && mantissa < (uint64_t(1) << 53)
+            && exponent >= -22 && exponent <= 22) {
+        double value = mantissa;
+        value = exponent < 0 ? value / powers[-exponent]
+            : value * powers[exponent];
+        out = negative ? -value : value;
+    } else {
+        // The mapping isn't null terminated, so strtod gets a copy
+        out = std::strtod(string(m_pos, p).c_str(), nullptr);
+    }
+    m_pos = p;
+    return true;
+}
+
+string Scanner::readLine() {
+    const char *start = m_pos;
+    while (m_pos != m_end && *m_pos != '\n') {
+        m_pos++;
+    }
+    const char *stop = m_pos;
+    if (stop != start && stop[-1] == '\r') {
+        stop--;
+    }
+    if (m_pos != m_end) {
+        m_pos++;
+    }
+    return string(start, stop);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+using std::string;
+
+// Cursor over a read-only memory mapping of a whole file, parsing numbers
+// straight from the mapped bytes instead of through a stream
+class Scanner {
+    const char *m_data;
+    size_t m_size;
+    const char *m_pos;
+    const char *m_end;
+
+    void skipSpace();
+
+    public:
+        explicit Scanner(const string &path);
+        ~Scanner();
+
+        Scanner(const Scanner &) = delete;
+        Scanner &operator=(const Scanner &) = delete;
+
+        // False if the file could not be opened or mapped
+        bool valid() const;
+
+        // Skips whitespace; true if nothing else is left
+        bool atEnd();
+
+        // Next non-whitespace character, or '\0' at the end of the file
+        char peek();
+
+        // Reads an optionally signed decimal integer after any whitespace
+        bool readInt(int &out);
+
+        // Reads a decimal floating point number, as written by printf's
+        // %f, %e or %g formats, after any whitespace
+        bool readDouble(double &out);
+
+        // Rest of the current line, without its line break
+        string readLine();
+};
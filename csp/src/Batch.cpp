@@ -0,0 +1,69 @@
+#include "Batch.h"
+#include "CSP.h"
+
+#include <glpk.h>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::cout;
+using std::string;
+using std::vector;
+
+// Solves every instance on a pool of worker threads, each one running a
+// single CSP at a time. Output is buffered per instance and printed in
+// instance order as soon as all previous instances are done.
+void solveBatch(const vector<Instance> &instances, Options opts, int threads,
+        bool debug) {
+    int count = instances.size();
+
+    // GLPK can only be used from several threads when its environment is
+    // thread-local
+    if (glp_config("TLS") == NULL) {
+        threads = 1;
+    }
+
+    vector<string> results(count);
+    vector<char> done(count, 0);
+    int next_to_print = 0;
+    std::atomic<int> next_instance(0);
+    std::mutex output_mutex;
+
+    auto worker = [&]() {
+        while (true) {
+            int k = next_instance++;
+            if (k >= count) {
+                break;
+            }
+
+            std::ostringstream out;
+            CSP csp(instances[k].title, instances[k].pd, opts, out);
+            csp.solve(debug);
+
+            std::lock_guard<std::mutex> lock(output_mutex);
+            results[k] = out.str();
+            done[k] = 1;
+            while (next_to_print < count && done[next_to_print]) {
+                cout << results[next_to_print];
+                results[next_to_print].clear();
+                next_to_print++;
+            }
+            cout.flush();
+        }
+
+        // Each thread has its own GLPK environment
+        glp_free_env();
+    };
+
+    vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back(worker);
+    }
+    for (std::thread &thread : workers) {
+        thread.join();
+    }
+}
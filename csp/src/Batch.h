@@ -0,0 +1,11 @@
+#pragma once
+
+#include <vector>
+
+#include "ProblemData.h"
+#include "Options.h"
+
+using std::vector;
+
+void solveBatch(const vector<Instance> &instances, Options opts, int threads,
+        bool debug);
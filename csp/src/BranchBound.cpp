@@ -0,0 +1,110 @@
+#include "BranchBound.h"
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+#include <cassert>
+
+using std::vector;
+using std::min;
+
+const double EPSILON = 1e-9;
+
+BranchBound::BranchBound(int cap, const vector<int> &weights,
+        const vector<int> &demands)
+    : m_cap(cap), m_weights(weights), m_values(nullptr), best_value(0) {
+    assert(weights.size() == demands.size());
+    int items = weights.size();
+
+    for (int i = 0; i < items; i++) {
+        m_bounds.push_back(min(demands[i], cap / weights[i]));
+    }
+
+    current = vector<int>(items, 0);
+    best = vector<int>(items, 0);
+}
+
+double BranchBound::solve(const vector<double> &values, Pattern &pattern) {
+    assert(values.size() == m_weights.size());
+    int items = m_weights.size();
+    m_values = &values;
+
+    // Items which can improve a pattern, by decreasing value per unit width
+    order.clear();
+    for (int i = 0; i < items; i++) {
+        if (values[i] > 0 && m_bounds[i] > 0) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return values[a] * m_weights[b] > values[b] * m_weights[a];
+    });
+
+    std::fill(current.begin(), current.end(), 0);
+    std::fill(best.begin(), best.end(), 0);
+    best_value = 0;
+
+    search(0, m_cap, 0);
+
+    pattern.clear();
+    for (int i = 0; i < items; i++) {
+        if (best[i] > 0) {
+            pattern.add(i, best[i]);
+        }
+    }
+    return best_value;
+}
+
+// Value of the LP relaxation of the items from order[k] onwards: take
+// items whole by decreasing ratio, then a fraction of the first one that
+// does not fit.
+double BranchBound::upperBound(int k, int cap_left) {
+    const vector<double> &values = *m_values;
+    int len = order.size();
+    double bound = 0;
+    for (int p = k; p < len && cap_left > 0; p++) {
+        int i = order[p];
+        int fit = cap_left / m_weights[i];
+        if (fit >= m_bounds[i]) {
+            bound += m_bounds[i] * values[i];
+            cap_left -= m_bounds[i] * m_weights[i];
+        } else {
+            bound += values[i] * cap_left / m_weights[i];
+            break;
+        }
+    }
+    return bound;
+}
+
+void BranchBound::search(int k, int cap_left, double value) {
+    if (value > best_value + EPSILON) {
+        best_value = value;
+        best = current;
+    }
+
+    if (k == static_cast<int>(order.size())) {
+        return;
+    }
+
+    if (value + upperBound(k, cap_left) <= best_value + EPSILON) {
+        return;
+    }
+
+    // Branch on the number of copies of item order[k], most copies first
+    int i = order[k];
+    int max_count = min(m_bounds[i], cap_left / m_weights[i]);
+    for (int c = max_count; c >= 0; c--) {
+        current[i] = c;
+        search(k + 1, cap_left - c * m_weights[i],
+                value + c * (*m_values)[i]);
+    }
+    current[i] = 0;
+}
+
+void BranchBound::printInfo(std::ostream &out) {
+    out << "Branch-and-bound pricing, item bounds:";
+    for (int bound : m_bounds) {
+        out << " " << bound;
+    }
+    out << "\n";
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "Pricer.h"
+
+using std::vector;
+
+// Depth-first branch-and-bound for the bounded knapsack problem, in the
+// style of Martello and Toth. Items are explored by decreasing
+// value/weight ratio and nodes are pruned with the LP relaxation bound.
+// Each item is used at most min(demand, cap / weight) times, since a
+// pattern never needs more copies of a width than its demand.
+class BranchBound : public Pricer {
+    int m_cap;
+    vector<int> m_weights;
+    vector<int> m_bounds;
+
+    // Search state, reused across calls
+    const vector<double> *m_values;
+    vector<int> order;
+    vector<int> current;
+    vector<int> best;
+    double best_value;
+
+    double upperBound(int k, int cap_left);
+    void search(int k, int cap_left, double value);
+
+    public:
+        BranchBound(int cap, const vector<int> &weights,
+                const vector<int> &demands);
+
+        double solve(const vector<double> &values,
+                Pattern &pattern) override;
+        void printInfo(std::ostream &out) override;
+};
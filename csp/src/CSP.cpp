@@ -1,36 +1,61 @@
 #include "CSP.h"
 #include "LPP.h"
 #include "Knapsack.h"
+#include "BranchBound.h"
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <cmath>
 #include <ctime>
+#include <limits>
+#include <utility>
 
-using std::cout;
 using std::string;
-using std::abs;
 
 const double PRECISION = 0.001;
 
-CSP::CSP(string title, ProblemData pd) : title(title), pd(pd) {
+// CPU time used by the calling thread, in seconds. std::clock() would count
+// every thread of the process when instances are solved in parallel.
+double cpuTime() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+std::unique_ptr<Pricer> makePricer(const ProblemData &pd,
+        const Options &opts) {
+    switch (opts.pricing) {
+        case PricingMode::branch_bound:
+            return std::unique_ptr<Pricer>(
+                    new BranchBound(pd.stock_width, pd.widths, pd.demands));
+        case PricingMode::reduced:
+            return std::unique_ptr<Pricer>(
+                    new Knapsack(pd.stock_width, pd.widths, true));
+        default:
+            return std::unique_ptr<Pricer>(
+                    new Knapsack(pd.stock_width, pd.widths));
+    }
+}
+
+CSP::CSP(string title, ProblemData pd, Options opts, std::ostream &out)
+    : title(title), pd(pd), opts(opts), out(out), pricer(makePricer(pd, opts)),
+      heuristic(pd.stock_width, pd.widths) {
     // Do nothing
 }
 
 void CSP::printProblemData() {
-    cout << pd.cuts << " cuts:" << "\n";
+    out << pd.cuts << " cuts:" << "\n";
     for (int i = 0; i < pd.cuts; i++) {
-        cout << "Width " << pd.widths[i]
+        out << "Width " << pd.widths[i]
              << ": " << pd.demands[i] << " units \n";
     }
 }
 
-vector<vector<int>> genTrivialPatterns(ProblemData &pd) {
-    vector<vector<int>> patterns;
+vector<Pattern> genTrivialPatterns(ProblemData &pd) {
+    vector<Pattern> patterns(pd.cuts);
     for (int c = 0; c < pd.cuts; c++) {
-        vector<int> pattern(pd.cuts, 0);
-        pattern[c] = pd.stock_width / pd.widths[c];
-        patterns.push_back(pattern);
+        patterns[c].add(c, pd.stock_width / pd.widths[c]);
     }
     return patterns;
 }
@@ -42,41 +67,240 @@ LPP CSP::initializeLPP() {
         lpp.addRow(LPBounds::fixed, demand, demand);
     }
 
-    vector<vector<int>> patterns = genTrivialPatterns(pd);
-    for (vector<int> &pattern : patterns) {
-        lpp.addCol(1, LPBounds::lower, 0, 0);
-        lpp.addConstrCol(pattern);
+    columns.clear();
+    for (Pattern &pattern : genTrivialPatterns(pd)) {
+        columns.add(pattern);
+    }
+    lpp.addColumns(columns, 0, 1, LPBounds::lower, 0, 0);
+
+    // Each trivial pattern covers its own width, so together they form a
+    // feasible starting basis
+    if (opts.warm_start) {
+        lpp.setColumnBasis(0);
     }
 
     return lpp;
 }
 
+// Moves columns which have been useless for too long from the master to the
+// pool. The trivial patterns are always kept, so the master stays feasible.
+void CSP::purgeColumns(LPP &lpp) {
+    int count = columns.size();
+    column_age.resize(count, 0);
+
+    purged.clear();
+    for (int j = 0; j < count; j++) {
+        if (j >= pd.cuts && !lpp.basicCol(j)
+                && lpp.reducedCost(j) > PRECISION) {
+            column_age[j]++;
+        } else {
+            column_age[j] = 0;
+        }
+
+        if (column_age[j] > opts.purge_age) {
+            purged.push_back(j);
+        }
+    }
+    if (purged.empty()) {
+        return;
+    }
+
+    // Kept columns are compacted, following the LP's renumbering
+    scratch_block.clear();
+    int next = 0;
+    for (int j = 0; j < count; j++) {
+        if (next < static_cast<int>(purged.size()) && purged[next] == j) {
+            pool.add(columns, j);
+            next++;
+        } else {
+            column_age[scratch_block.size()] = column_age[j];
+            scratch_block.add(columns, j);
+        }
+    }
+
+    lpp.deleteColumns(purged);
+    std::swap(columns, scratch_block);
+    column_age.resize(columns.size());
+    purged_columns += purged.size();
+}
+
+// Looks for improving columns among the purged ones. Up to opts.columns of
+// the best are moved from the pool to patterns, and the best value found is
+// returned (0 if the pool is empty).
+double CSP::priceFromPool(double threshold) {
+    patterns.clear();
+
+    pool_candidates.clear();
+    double best = 0;
+    for (int c = 0; c < pool.size(); c++) {
+        double value = pool.value(c, duals);
+        best = std::max(best, value);
+        if (value > threshold) {
+            pool_candidates.push_back(std::make_pair(value, c));
+        }
+    }
+    if (pool_candidates.empty()) {
+        return best;
+    }
+
+    std::sort(pool_candidates.begin(), pool_candidates.end(),
+            [](const std::pair<double, int> &a,
+                const std::pair<double, int> &b) {
+                return a.first > b.first;
+            });
+    if (static_cast<int>(pool_candidates.size()) > opts.columns) {
+        pool_candidates.resize(opts.columns);
+    }
+
+    // Columns go back to the master in pattern order
+    std::sort(pool_candidates.begin(), pool_candidates.end(),
+            [](const std::pair<double, int> &a,
+                const std::pair<double, int> &b) {
+                return a.second < b.second;
+            });
+    scratch_block.clear();
+    size_t next = 0;
+    for (int c = 0; c < pool.size(); c++) {
+        if (next < pool_candidates.size()
+                && pool_candidates[next].second == c) {
+            patterns.push_back(pool.pattern(c));
+            next++;
+        } else {
+            scratch_block.add(pool, c);
+        }
+    }
+    std::swap(pool, scratch_block);
+
+    return best;
+}
+
+// Lower bound on the master LP given by any dual vector pi: scaled down by
+// the knapsack value, pi is dual feasible, so demands * pi / value bounds
+// the number of rolls (Farley's bound).
+double CSP::lagrangianBound(const vector<double> &pi, double knapsack_value) {
+    if (knapsack_value <= PRECISION) {
+        return std::numeric_limits<double>::lowest();
+    }
+
+    double total = 0;
+    for (int i = 0; i < pd.cuts; i++) {
+        total += pd.demands[i] * pi[i];
+    }
+    return total / knapsack_value;
+}
+
+// Exact pricing, with optional dual stabilization. Patterns are priced at a
+// separation point between the stability center and the master duals, and
+// only kept if they are improving for the master duals themselves. If none
+// is, the round was mis-priced and is repeated with the raw duals, which is
+// also the only way to prove the master optimal.
+double CSP::priceExact(double threshold) {
+    bool stabilize = (opts.smoothing > 0 || opts.box > 0) && !center.empty();
+    if (stabilize) {
+        separation.resize(pd.cuts);
+        for (int i = 0; i < pd.cuts; i++) {
+            double pi = opts.smoothing * center[i]
+                + (1 - opts.smoothing) * duals[i];
+            if (opts.box > 0) {
+                pi = std::max(pi, center[i] - opts.box);
+                pi = std::min(pi, center[i] + opts.box);
+            }
+            separation[i] = pi;
+        }
+
+        double value = pricer->solveMany(separation, opts.columns, threshold,
+                patterns);
+        exact_calls++;
+
+        double bound = lagrangianBound(separation, value);
+        lower_bound = std::max(lower_bound, bound);
+        if (bound > center_bound) {
+            center = separation;
+            center_bound = bound;
+        }
+
+        patterns.erase(std::remove_if(patterns.begin(), patterns.end(),
+                    [&](const Pattern &pattern) {
+                        return pattern.value(duals) <= threshold;
+                    }), patterns.end());
+        if (!patterns.empty()) {
+            stabilized_rounds++;
+            return value;
+        }
+        mispricings++;
+    }
+
+    double value = pricer->solveMany(duals, opts.columns, threshold,
+            patterns);
+    exact_calls++;
+
+    double bound = lagrangianBound(duals, value);
+    lower_bound = std::max(lower_bound, bound);
+    if (center.empty() || bound > center_bound) {
+        center = duals;
+        center_bound = bound;
+    }
+
+    return value;
+}
+
 // Required data:
 // - Number of master problems solved
 // - Total CPU time
 // - CPU time for pricing problems
 // - Final master problem objective value
+// - Pricing rounds solved by the heuristic, and calls to the exact pricer
+// - Number of columns generated by pricing
+// - Total simplex iterations over all master solutions
+// - Columns purged from the master, and pricing rounds solved from the pool
+// - Exact pricing rounds solved at a stabilized dual point, and mis-pricings
+// - Best Lagrangian lower bound on the master objective
 void CSP::printSolution(LPP &lpp, bool debug) {
     if (debug) {
-        cout << "Solution found!\n";
+        out << "Solution found!\n";
 
-        cout << "Patterns:\n";
+        out << "Patterns:\n";
         vector<double> pattern_counts = lpp.primalVars();
         int variables = pattern_counts.size();
+        const vector<int> &rows = columns.rows();
+        const vector<double> &values = columns.values();
         for (int i = 0; i < variables; i++) {
-            cout << "x" << i << ": " << pattern_counts[i] << "\n";
+            out << "x" << i << ": " << pattern_counts[i] << " (";
+            for (int k = columns.begin(i); k < columns.end(i); k++) {
+                out << (k == columns.begin(i) ? "" : ", ")
+                    << values[k] << "x" << pd.widths[rows[k]];
+            }
+            out << ")\n";
         }
 
-        cout << "Master problem solutions: " << master_solutions << "\n";
-        cout << "Total CPU time: " << total_time << " seconds\n";
-        cout << "Pricing CPU time: " << pricing_time << " seconds\n";
-        cout << "Objective function value: " << lpp.objective() << "\n";
+        out << "Master problem solutions: " << master_solutions << "\n";
+        out << "Total CPU time: " << total_time << " seconds\n";
+        out << "Pricing CPU time: " << pricing_time << " seconds\n";
+        out << "Objective function value: " << lpp.objective() << "\n";
+        out << "Heuristic pricing hits: " << heuristic_hits << "\n";
+        out << "Exact pricing calls: " << exact_calls << "\n";
+        out << "Generated columns: " << generated_columns << "\n";
+        out << "Simplex iterations: " << simplex_iterations << "\n";
+        out << "Purged columns: " << purged_columns << "\n";
+        out << "Pool pricing hits: " << pool_hits << "\n";
+        out << "Stabilized pricing rounds: " << stabilized_rounds << "\n";
+        out << "Mis-pricings: " << mispricings << "\n";
+        out << "Lower bound: " << lower_bound << "\n";
     } else {
-        cout << title << " & "
+        out << title << " & "
             << master_solutions << " & "
             << total_time << " & "
             << pricing_time << " & "
-            << lpp.objective() << "\n";
+            << lpp.objective() << " & "
+            << heuristic_hits << " & "
+            << exact_calls << " & "
+            << generated_columns << " & "
+            << simplex_iterations << " & "
+            << purged_columns << " & "
+            << pool_hits << " & "
+            << stabilized_rounds << " & "
+            << mispricings << " & "
+            << lower_bound << "\n";
     }
 }
 
@@ -84,41 +308,107 @@ void CSP::solve(bool debug) {
     bool silent = !debug;
 
     if (!silent) {
-        cout << "Solve " << title << "\n";
+        out << "Solve " << title << "\n";
         printProblemData();
+        pricer->printInfo(out);
     } else {
         LPP::termOut(silent);
     }
 
-    clock_t begin = std::clock();
+    double begin = cpuTime();
 
     LPP lpp = initializeLPP();
     master_solutions = 0;
+    simplex_iterations = 0;
     // total_time not initialized because it's not computed incrementally
     pricing_time = 0;
+    heuristic_hits = 0;
+    exact_calls = 0;
+    generated_columns = 0;
+    purged_columns = 0;
+    pool_hits = 0;
+    column_age.clear();
+    pool.clear();
+    stabilized_rounds = 0;
+    mispricings = 0;
+    center.clear();
+    lower_bound = 0;
+    double threshold = 1 + PRECISION;
 
     while (true) {
-        lpp.simplex();
+        if (opts.warm_start) {
+            lpp.reoptimize();
+        } else {
+            lpp.simplex();
+        }
         master_solutions++;
+        simplex_iterations += lpp.lastIterations();
 
-        clock_t pricing_begin = std::clock();
-        Knapsack ks(pd.stock_width, pd.widths, lpp.dualVars());
-        clock_t pricing_end = std::clock();
-        pricing_time += double(pricing_end - pricing_begin) / CLOCKS_PER_SEC;
+        if (!silent) {
+            out << "Master " << master_solutions << ": "
+                << lpp.lastIterations() << " simplex iterations, objective "
+                << lpp.objective() << "\n";
+        }
 
+        double pricing_begin = cpuTime();
+        lpp.dualVars(duals);
 
-        if (abs(ks.solution() - 1) <= PRECISION) {
-            clock_t end = std::clock();
-            total_time = double(end - begin) / CLOCKS_PER_SEC;
+        // Purged columns are priced first, then the heuristic. Only the
+        // exact pricer can prove optimality, so it runs whenever neither
+        // finds an improving column.
+        double value = 0;
+        bool improving = false;
+        bool from_pool = false;
+        if (opts.purge_age > 0) {
+            purgeColumns(lpp);
+            value = priceFromPool(threshold);
+            improving = from_pool = !patterns.empty();
+            if (improving) {
+                pool_hits++;
+            }
+        }
+        if (!improving && opts.heuristic) {
+            value = heuristic.solveMany(duals, opts.columns, threshold,
+                    patterns);
+            improving = !patterns.empty();
+            if (improving) {
+                heuristic_hits++;
+            }
+        }
+        if (!improving) {
+            value = priceExact(threshold);
+        }
+        pricing_time += cpuTime() - pricing_begin;
+
+
+        // Any integer solution uses a whole number of rolls, so once both
+        // bounds round up to the same value there is nothing left to prove
+        double upper_bound = lpp.objective();
+        bool bounds_met = opts.early_stop && std::ceil(lower_bound - PRECISION)
+            >= std::ceil(upper_bound - PRECISION);
+
+        if (!silent) {
+            out << "LB: " << lower_bound << ", UB: " << upper_bound << "\n";
+        }
+
+        if (patterns.empty() || bounds_met) {
+            total_time = cpuTime() - begin;
 
             printSolution(lpp, debug);
             return;
         } else {
             if (!silent) {
-                cout << "Knapsack value: " << ks.solution() << "\n";
+                out << "Knapsack value: " << value << ", "
+                    << patterns.size() << " new columns\n";
+            }
+            int first = columns.size();
+            for (Pattern &pattern : patterns) {
+                columns.add(pattern);
+            }
+            lpp.addColumns(columns, first, 1, LPBounds::lower, 0, 0);
+            if (!from_pool) {
+                generated_columns += patterns.size();
             }
-            lpp.addCol(1, LPBounds::lower, 0, 0);
-            lpp.addConstrCol(ks.solution_counts());
         }
     }
 }
@@ -4,26 +4,75 @@
 
 #include <glpk.h>
 #include <ctime>
+#include <iostream>
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "ProblemData.h"
 #include "LPP.h"
+#include "Pattern.h"
+#include "PatternBlock.h"
+#include "Pricer.h"
+#include "Greedy.h"
+#include "Options.h"
 
 using std::string;
+using std::vector;
 
 class CSP {
     string title;
     ProblemData pd;
+    Options opts;
+    std::ostream &out;
 
     int master_solutions;
+    int simplex_iterations;
     double total_time;
     double pricing_time;
+    int heuristic_hits;
+    int exact_calls;
+    int generated_columns;
+    int purged_columns;
+    int pool_hits;
+    int stabilized_rounds;
+    int mispricings;
+    double lower_bound;
+
+    // Pricing workspace, reused across column generation iterations
+    std::unique_ptr<Pricer> pricer;
+    Greedy heuristic;
+    vector<double> duals;
+    vector<Pattern> patterns;
+
+    // Patterns of every master problem column, in column order
+    PatternBlock columns;
+
+    // Column management: consecutive iterations each master column has
+    // been non-basic with positive reduced cost, and patterns removed from
+    // the master
+    vector<int> column_age;
+    PatternBlock pool;
+    PatternBlock scratch_block;
+    vector<int> purged;
+    vector<std::pair<double, int>> pool_candidates;
+
+    // Dual stabilization: the stability center is the dual vector with the
+    // best Lagrangian bound seen so far
+    vector<double> center;
+    double center_bound;
+    vector<double> separation;
 
     LPP initializeLPP();
+    void purgeColumns(LPP &lpp);
+    double priceFromPool(double threshold);
+    double priceExact(double threshold);
+    double lagrangianBound(const vector<double> &pi, double knapsack_value);
     void printSolution(LPP &lpp, bool debug);
 
     public:
-        CSP(string title, ProblemData pd);
+        CSP(string title, ProblemData pd, Options opts = Options(),
+                std::ostream &out = std::cout);
         void printProblemData();
         void solve(bool debug);
 };
@@ -0,0 +1,41 @@
+#include "Greedy.h"
+
+#include <algorithm>
+#include <vector>
+#include <cassert>
+
+using std::vector;
+
+Greedy::Greedy(int cap, const vector<int> &weights)
+    : m_cap(cap), m_weights(weights) {
+    // Do nothing
+}
+
+double Greedy::solve(const vector<double> &values, Pattern &pattern) {
+    assert(values.size() == m_weights.size());
+    int items = m_weights.size();
+
+    order.clear();
+    for (int i = 0; i < items; i++) {
+        if (values[i] > 0) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return values[a] * m_weights[b] > values[b] * m_weights[a];
+    });
+
+    pattern.clear();
+    double value = 0;
+    int cap_left = m_cap;
+    for (int i : order) {
+        int copies = cap_left / m_weights[i];
+        if (copies > 0) {
+            pattern.add(i, copies);
+            value += copies * values[i];
+            cap_left -= copies * m_weights[i];
+        }
+    }
+
+    return value;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+#include "Pricer.h"
+
+using std::vector;
+
+// Greedy pricing heuristic: takes items by decreasing value/weight ratio,
+// as many copies of each as still fit. Cheap, but its value is only a lower
+// bound on the knapsack optimum, so it can't prove the master is optimal.
+class Greedy : public Pricer {
+    int m_cap;
+    vector<int> m_weights;
+    vector<int> order;
+
+    public:
+        Greedy(int cap, const vector<int> &weights);
+
+        double solve(const vector<double> &values,
+                Pattern &pattern) override;
+};
@@ -1,25 +1,88 @@
 #include "Knapsack.h"
 
+#include <algorithm>
+#include <ostream>
+#include <utility>
 #include <vector>
+#include <limits>
 #include <cassert>
 
 using std::vector;
+using std::pair;
+using std::numeric_limits;
 
-Knapsack::Knapsack(int cap, const vector<int> &weights,
-        const vector<double> &values) {
-    assert(weights.size() == values.size());
-    int items = weights.size();
+static int greatestCommonDivisor(int a, int b) {
+    while (b != 0) {
+        int r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+Knapsack::Knapsack(int cap, const vector<int> &weights, bool reduce)
+    : m_full_cap(cap), m_cap(cap), m_weights(weights), m_reduce(reduce),
+      m_gcd(1) {
+    if (m_reduce) {
+        // Only multiples of the GCD can be filled, so everything is scaled
+        // down by it; the leftover capacity cap % gcd is always waste.
+        m_gcd = 0;
+        for (int weight : m_weights) {
+            m_gcd = greatestCommonDivisor(weight, m_gcd);
+        }
+        if (m_gcd == 0) {
+            m_gcd = 1; // no items
+        }
+        for (int &weight : m_weights) {
+            weight /= m_gcd;
+        }
+        m_cap /= m_gcd;
+
+        // Capacities which are exactly the sum of some multiset of weights.
+        // Computed once per instance, since weights never change.
+        m_reachable = vector<char>(m_cap + 1, 0);
+        m_reachable[0] = 1;
+        for (int w = 1; w <= m_cap; w++) {
+            for (int weight : m_weights) {
+                if (weight <= w && m_reachable[w - weight]) {
+                    m_reachable[w] = 1;
+                    m_states.push_back(w);
+                    break;
+                }
+            }
+        }
+    }
+
+    partial_max = vector<double>(m_cap + 1, 0);
+    last_item = vector<int>(m_cap + 1, -1);
+}
+
+double Knapsack::solve(const vector<double> &values, Pattern &pattern) {
+    assert(m_weights.size() == values.size());
 
-    vector<double> partial_max{0};
-    vector<int> initial_count(items, 0);
-    vector<vector<int>> counts{initial_count};
+    if (m_reduce) {
+        return solveReduced(values, pattern);
+    } else {
+        return solveDense(values, pattern);
+    }
+}
 
-    for (int w = 1; w <= cap; w++) {
+double Knapsack::solveDense(const vector<double> &values,
+        Pattern &pattern) {
+    int items = m_weights.size();
+
+    // partial_max[w]: best value achievable with capacity w
+    // last_item[w]: item added last to reach partial_max[w], or -1 if the
+    // optimal solution for w is the same as the one for w - 1
+    partial_max[0] = 0;
+    last_item[0] = -1;
+
+    for (int w = 1; w <= m_cap; w++) {
         double local_max = partial_max[w - 1];
         int max_item = -1;
         for (int i = 0; i < items; i++) {
-            if (weights[i] <= w) {
-                double candidate = partial_max[w - weights[i]] + values[i];
+            if (m_weights[i] <= w) {
+                double candidate = partial_max[w - m_weights[i]] + values[i];
                 if (candidate > local_max) {
                     local_max = candidate;
                     max_item = i;
@@ -27,25 +90,152 @@ Knapsack::Knapsack(int cap, const vector<int> &weights,
             }
         }
 
-        partial_max.push_back(local_max);
+        partial_max[w] = local_max;
+        last_item[w] = max_item;
+    }
+
+    pattern.clear();
+    rebuild(m_cap, pattern);
+    return partial_max[m_cap];
+}
+
+double Knapsack::solveReduced(const vector<double> &values,
+        Pattern &pattern) {
+    int items = m_weights.size();
+
+    // partial_max[w]: best value of a pattern using exactly capacity w,
+    // only meaningful for reachable w.
+    // last_item[w]: item added last to reach partial_max[w]
+    partial_max[0] = 0;
+    last_item[0] = -1;
+
+    double best = 0;
+    int best_w = 0;
 
-        if (max_item == -1) {
-            counts.push_back(counts[w - 1]);
+    for (int w : m_states) {
+        double local_max = numeric_limits<double>::lowest();
+        int max_item = -1;
+        for (int i = 0; i < items; i++) {
+            int rest = w - m_weights[i];
+            if (rest >= 0 && m_reachable[rest]) {
+                double candidate = partial_max[rest] + values[i];
+                if (candidate > local_max) {
+                    local_max = candidate;
+                    max_item = i;
+                }
+            }
+        }
+
+        partial_max[w] = local_max;
+        last_item[w] = max_item;
+
+        if (local_max > best) {
+            best = local_max;
+            best_w = w;
+        }
+    }
+
+    pattern.clear();
+    rebuild(best_w, pattern);
+    return best;
+}
+
+// Walks back from capacity w, following the last item chosen at each step,
+// and adds the items found to pattern
+void Knapsack::rebuild(int w, Pattern &pattern) {
+    while (w > 0) {
+        int item = last_item[w];
+        if (item == -1) {
+            w--;
         } else {
-            vector<int> new_counts = counts[w - weights[max_item]];
-            new_counts[max_item]++;
-            counts.push_back(new_counts);
+            pattern.add(item, 1);
+            w -= m_weights[item];
+        }
+    }
+}
+
+// Besides the optimal pattern, combines the best pattern ending at each
+// capacity w with the best one fitting in the leftover cap - w, both read
+// from the DP table of the last solve, and keeps the k best distinct ones.
+double Knapsack::solveMany(const vector<double> &values, int k,
+        double threshold, vector<Pattern> &patterns) {
+    patterns.resize(1);
+    double value = solve(values, patterns[0]);
+    if (value <= threshold || k < 1) {
+        patterns.clear();
+        return value;
+    }
+    if (k == 1) {
+        return value;
+    }
+
+    // best_within[r]: capacity of the best DP state fitting in r
+    best_within.resize(m_cap + 1);
+    if (m_reduce) {
+        int best_w = 0;
+        for (int r = 0; r <= m_cap; r++) {
+            if (m_reachable[r] && partial_max[r] > partial_max[best_w]) {
+                best_w = r;
+            }
+            best_within[r] = best_w;
+        }
+    } else {
+        for (int r = 0; r <= m_cap; r++) {
+            best_within[r] = r;
+        }
+    }
+
+    // Only states where an item was actually added start new patterns
+    candidates.clear();
+    for (int w = 1; w <= m_cap; w++) {
+        if ((!m_reduce || m_reachable[w]) && last_item[w] != -1) {
+            double total = partial_max[w] + partial_max[best_within[m_cap - w]];
+            if (total > threshold) {
+                candidates.push_back(std::make_pair(total, w));
+            }
         }
     }
+    std::sort(candidates.begin(), candidates.end(),
+            [](const pair<double, int> &a, const pair<double, int> &b) {
+                return a.first > b.first;
+            });
+
+    Pattern pattern;
+    for (const pair<double, int> &candidate : candidates) {
+        if (static_cast<int>(patterns.size()) >= k) {
+            break;
+        }
 
-    m_solution_counts = counts.back();
-    m_solution = partial_max.back();
+        int w = candidate.second;
+        pattern.clear();
+        rebuild(w, pattern);
+        rebuild(best_within[m_cap - w], pattern);
+
+        if (std::find(patterns.begin(), patterns.end(), pattern) ==
+                patterns.end()) {
+            patterns.push_back(pattern);
+        }
+    }
+
+    return value;
+}
+
+void Knapsack::printInfo(std::ostream &out) {
+    if (m_reduce) {
+        out << "Reduced pricing: GCD " << m_gcd << ", "
+            << states() << " reachable capacities, "
+            << skippedStates() << " of " << m_full_cap
+            << " dense DP states skipped per call\n";
+    }
 }
 
-vector<int> Knapsack::solution_counts() {
-    return m_solution_counts;
+// Number of capacities visited by each DP pass
+int Knapsack::states() {
+    return m_reduce ? m_states.size() : m_cap;
 }
 
-double Knapsack::solution() {
-    return m_solution;
+// Capacities the dense DP over the original stock width would visit, but
+// this one does not
+int Knapsack::skippedStates() {
+    return m_full_cap - states();
 }
@@ -1,15 +1,45 @@
 #pragma once
 
+#include <utility>
 #include <vector>
 
+#include "Pricer.h"
+
 using std::vector;
 
-class Knapsack {
-    vector<int> m_solution_counts;
-    double m_solution;
+class Knapsack : public Pricer {
+    int m_full_cap;
+    int m_cap;
+    vector<int> m_weights;
+
+    // Reduced mode: capacities and weights are divided by the GCD of the
+    // weights, and the DP only visits capacities that are sums of weights
+    bool m_reduce;
+    int m_gcd;
+    vector<char> m_reachable;
+    vector<int> m_states;
+
+    // DP tables, sized once and reused by every call to solve()
+    vector<double> partial_max;
+    vector<int> last_item;
+
+    // solveMany() buffers
+    vector<int> best_within;
+    vector<std::pair<double, int>> candidates;
+
+    double solveDense(const vector<double> &values, Pattern &pattern);
+    double solveReduced(const vector<double> &values, Pattern &pattern);
+    void rebuild(int w, Pattern &pattern);
 
     public:
-        Knapsack(int cap, const vector<int> &weights, const vector<double> &values);
-        vector<int> solution_counts();
-        double solution();
+        Knapsack(int cap, const vector<int> &weights, bool reduce = false);
+
+        double solve(const vector<double> &values,
+                Pattern &pattern) override;
+        double solveMany(const vector<double> &values, int k,
+                double threshold, vector<Pattern> &patterns) override;
+        void printInfo(std::ostream &out) override;
+
+        int states();
+        int skippedStates();
 };
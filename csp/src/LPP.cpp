@@ -7,7 +7,7 @@
 using std::vector;
 
 LPP::LPP(ObjDir d)
-    : rows(0), cols(0), constr_rows(0), constr_cols(0) {
+    : rows(0), cols(0), constr_rows(0), constr_cols(0), last_iterations(0) {
     lp = glp_create_prob();
     glp_set_obj_dir(lp, static_cast<int>(d));
 }
@@ -23,73 +23,110 @@ void LPP::addRow(LPBounds bounds, double from, double to) {
     glp_set_row_bnds(lp, rows, static_cast<int>(bounds), from, to);
 }
 
-void LPP::addCol(double obj, LPBounds bounds, double from, double to) {
-    glp_add_cols(lp, 1);
-    cols++;
-    glp_set_col_bnds(lp, cols, static_cast<int>(bounds), from, to);
-    glp_set_obj_coef(lp, cols, obj);
-}
+// Adds the columns of block from index first onwards, all with the same
+// objective coefficient and bounds, using a single glp_add_cols call
+void LPP::addColumns(const PatternBlock &block, int first, double obj,
+        LPBounds bounds, double from, double to) {
+    int count = block.size() - first;
+    if (count <= 0) {
+        return;
+    }
 
-void LPP::addConstrCol(vector<int> col) {
     if (constr_rows == 0) {
-        constr_rows = col.size();
+        constr_rows = rows;
     }
-    assert(static_cast<int>(col.size()) == constr_rows);
-
-    int len = constr_rows;
-    int array_len = len + 1;
-
-    int *indices = new int[array_len];
-    double *coef = new double[array_len];
+    assert(constr_cols == cols);
+
+    glp_add_cols(lp, count);
+
+    const vector<int> &block_rows = block.rows();
+    const vector<double> &block_values = block.values();
+    for (int c = first; c < block.size(); c++) {
+        cols++;
+        glp_set_col_bnds(lp, cols, static_cast<int>(bounds), from, to);
+        glp_set_obj_coef(lp, cols, obj);
+
+        int len = block.end(c) - block.begin(c);
+        scratch_indices.resize(len + 1);
+        scratch_coef.resize(len + 1);
+        for (int k = 0; k < len; k++) {
+            assert(block_rows[block.begin(c) + k] < constr_rows);
+            scratch_indices[k + 1] = block_rows[block.begin(c) + k] + 1;
+            scratch_coef[k + 1] = block_values[block.begin(c) + k];
+        }
 
-    for (int i = 0; i < len; i++) {
-        indices[i + 1] = i + 1;
-        coef[i + 1] = col[i];
+        constr_cols++;
+        glp_set_mat_col(lp, constr_cols, len, scratch_indices.data(),
+                scratch_coef.data());
     }
-
-    constr_cols++;
-    glp_set_mat_col(lp, constr_cols, constr_rows, indices, coef);
-
-    delete[] indices;
 }
 
-void LPP::loadMatrix(vector<vector<double>> m) {
-    int matrix_len = rows * cols;
-    // GLPK works with 1-based indexing
-    int serial_array_len = matrix_len + 1;
+// Deletes the columns with the given 0-based indices. Deleting non-basic
+// columns keeps the current basis valid.
+void LPP::deleteColumns(const vector<int> &indices) {
+    int count = indices.size();
+    if (count == 0) {
+        return;
+    }
 
-    // Arrays to which the matrix and its indices will be serialized.
-    // (this is necessary due to GLPK's input format)
-    double *coef = new double[serial_array_len];
-    int *row_indices = new int[serial_array_len];
-    int *col_indices = new int[serial_array_len];
+    scratch_indices.resize(count + 1);
+    for (int k = 0; k < count; k++) {
+        scratch_indices[k + 1] = indices[k] + 1;
+    }
+    glp_del_cols(lp, count, scratch_indices.data());
 
-    int p = 1; // Index for the arrays above, 1-based
+    cols -= count;
+    constr_cols -= count;
+}
 
-    assert(static_cast<int>(m.size()) == rows);
-    for (int i = 0; i < rows; i++) {
-        assert(static_cast<int>(m[i].size()) == cols);
+void LPP::simplex() {
+    int start = glp_get_it_cnt(lp);
+    glp_simplex(lp, NULL);
+    last_iterations = glp_get_it_cnt(lp) - start;
+}
 
-        for (int j = 0; j < cols; j++) {
-            coef[p] = m[i][j];
-            row_indices[p] = i + 1;
-            col_indices[p] = j + 1;
-            p++;
-        }
+// Re-optimization for column generation: columns added since the last solve
+// are non-basic at zero, so the previous basis is still primal feasible and
+// primal simplex continues from it. Presolve is off, since it would discard
+// the basis.
+void LPP::reoptimize() {
+    glp_smcp params;
+    glp_init_smcp(&params);
+    params.msg_lev = GLP_MSG_ERR;
+    params.meth = GLP_PRIMAL;
+    params.pricing = GLP_PT_PSE;
+    params.r_test = GLP_RT_HAR;
+    params.presolve = GLP_OFF;
+
+    int start = glp_get_it_cnt(lp);
+    int err = glp_simplex(lp, &params);
+    if (err == GLP_EBADB || err == GLP_ESING || err == GLP_ECOND) {
+        // The warm-start basis is invalid, singular or ill-conditioned:
+        // restart from a crash basis
+        glp_adv_basis(lp, 0);
+        err = glp_simplex(lp, &params);
     }
+    assert(err == 0);
+    last_iterations = glp_get_it_cnt(lp) - start;
+}
 
-    glp_load_matrix(lp, matrix_len, row_indices, col_indices, coef);
-
-    constr_rows = rows;
-    constr_cols = cols;
-
-    delete[] coef;
-    delete[] row_indices;
-    delete[] col_indices;
+// Starting basis made of the columns first .. first + rows - 1, with every
+// row non-basic. Useful when those columns form a feasible basis, like the
+// trivial patterns of a cutting stock problem.
+void LPP::setColumnBasis(int first) {
+    assert(first + rows <= cols);
+    for (int i = 1; i <= rows; i++) { // 1-based
+        glp_set_row_stat(lp, i, GLP_NS);
+    }
+    for (int j = 1; j <= cols; j++) {
+        bool basic = j > first && j <= first + rows;
+        glp_set_col_stat(lp, j, basic ? GLP_BS : GLP_NL);
+    }
 }
 
-void LPP::simplex() {
-    glp_simplex(lp, NULL);
+// Simplex iterations performed by the last solve
+int LPP::lastIterations() {
+    return last_iterations;
 }
 
 double LPP::objective() {
@@ -113,6 +150,21 @@ vector<double> LPP::dualVars() {
 
 }
 
+void LPP::dualVars(vector<double> &out) {
+    out.resize(rows);
+    for (int i = 1; i <= rows; i++) { // 1-based
+        out[i - 1] = glp_get_row_dual(lp, i);
+    }
+}
+
+bool LPP::basicCol(int col) {
+    return glp_get_col_stat(lp, col + 1) == GLP_BS;
+}
+
+double LPP::reducedCost(int col) {
+    return glp_get_col_dual(lp, col + 1);
+}
+
 void LPP::termOut(bool silent) {
     glp_term_out(silent ? GLP_OFF : GLP_ON);
 }
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "PatternBlock.h"
+
 using std::string;
 using std::vector;
 
@@ -24,19 +26,30 @@ class LPP {
     glp_prob *lp;
     int rows, cols;
     int constr_rows, constr_cols;
+    int last_iterations;
+
+    // Scratch arrays for GLPK's 1-based sparse vectors, reused across calls
+    vector<int> scratch_indices;
+    vector<double> scratch_coef;
 
     public:
         LPP(ObjDir d);
         ~LPP();
 
         void addRow(LPBounds bounds, double from, double to);
-        void addCol(double obj, LPBounds bounds, double from, double to);
-        void addConstrCol(vector<int> col);
-        void loadMatrix(vector<vector<double>> m);
+        void addColumns(const PatternBlock &block, int first, double obj,
+                LPBounds bounds, double from, double to);
+        void deleteColumns(const vector<int> &indices);
         void simplex();
+        void reoptimize();
+        void setColumnBasis(int first);
+        int lastIterations();
         double objective();
         vector<double> primalVars();
         vector<double> dualVars();
+        void dualVars(vector<double> &out);
+        bool basicCol(int col);
+        double reducedCost(int col);
 
         static void termOut(bool silent);
 };
@@ -0,0 +1,41 @@
+#pragma once
+
+enum class PricingMode {
+    dense,  // DP over every capacity from 1 to the stock width
+    reduced, // DP over reachable capacities only, after dividing out the GCD
+    branch_bound // Bounded knapsack branch-and-bound, see BranchBound.h
+};
+
+// Algorithm settings for the column generation, set from the command line
+struct Options {
+    PricingMode pricing = PricingMode::dense;
+
+    // Try the greedy heuristic before the exact pricer on every iteration
+    bool heuristic = false;
+
+    // Maximum number of improving patterns added per master iteration
+    int columns = 1;
+
+    // Re-solve the master from the previous basis (LPP::reoptimize) instead
+    // of calling the simplex with default settings
+    bool warm_start = true;
+
+    // Remove a column from the master once it has been non-basic with
+    // positive reduced cost for more than this many consecutive iterations,
+    // keeping it in a pool which is priced before the knapsack. 0 disables.
+    int purge_age = 0;
+
+    // Dual stabilization: exact pricing uses a separation point which mixes
+    // the stability center into the master duals with this weight (Wentges
+    // smoothing), in [0, 1). 0 disables.
+    double smoothing = 0;
+
+    // Dual stabilization: the separation point is kept within this distance
+    // of the stability center in every coordinate (boxstep). 0 disables.
+    double box = 0;
+
+    // Stop as soon as the rounded up Lagrangian lower bound matches the
+    // rounded up master objective, which already proves the integer
+    // optimum's LP bound, instead of waiting for the LP optimum
+    bool early_stop = false;
+};
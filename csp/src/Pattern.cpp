@@ -0,0 +1,80 @@
+#include "Pattern.h"
+
+#include <vector>
+#include <cassert>
+
+using std::vector;
+
+Pattern::Pattern() : m_size(0), m_inline() {
+    // Do nothing
+}
+
+Pattern::Entry &Pattern::entry(int k) {
+    return k < INLINE_ENTRIES ? m_inline[k] : m_overflow[k - INLINE_ENTRIES];
+}
+
+const Pattern::Entry &Pattern::entry(int k) const {
+    return k < INLINE_ENTRIES ? m_inline[k] : m_overflow[k - INLINE_ENTRIES];
+}
+
+void Pattern::clear() {
+    m_size = 0;
+    m_overflow.clear();
+}
+
+// Adds count copies of item, keeping entries sorted by item
+void Pattern::add(int item, int count) {
+    assert(count > 0);
+
+    int k = 0;
+    while (k < m_size && entry(k).item < item) {
+        k++;
+    }
+    if (k < m_size && entry(k).item == item) {
+        entry(k).count += count;
+        return;
+    }
+
+    // Open a slot at position k for the new entry
+    if (m_size >= INLINE_ENTRIES) {
+        m_overflow.push_back(Entry{0, 0});
+    }
+    m_size++;
+    for (int p = m_size - 1; p > k; p--) {
+        entry(p) = entry(p - 1);
+    }
+    entry(k) = Entry{item, count};
+}
+
+int Pattern::size() const {
+    return m_size;
+}
+
+int Pattern::item(int k) const {
+    return entry(k).item;
+}
+
+int Pattern::count(int k) const {
+    return entry(k).count;
+}
+
+// Total value of the pattern, given the value of each item
+double Pattern::value(const vector<double> &values) const {
+    double total = 0;
+    for (int k = 0; k < m_size; k++) {
+        total += values[entry(k).item] * entry(k).count;
+    }
+    return total;
+}
+
+bool Pattern::operator==(const Pattern &other) const {
+    if (m_size != other.m_size) {
+        return false;
+    }
+    for (int k = 0; k < m_size; k++) {
+        if (item(k) != other.item(k) || count(k) != other.count(k)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+using std::vector;
+
+// Sparse cutting pattern: (item, count) entries for the items it uses,
+// sorted by item. A typical pattern has a handful of entries, which are
+// stored inline; only larger patterns spill over to the heap.
+class Pattern {
+    struct Entry {
+        int item;
+        int count;
+    };
+
+    static const int INLINE_ENTRIES = 8;
+
+    int m_size;
+    Entry m_inline[INLINE_ENTRIES];
+    vector<Entry> m_overflow;
+
+    Entry &entry(int k);
+    const Entry &entry(int k) const;
+
+    public:
+        Pattern();
+
+        void clear();
+        void add(int item, int count);
+
+        int size() const;
+        int item(int k) const;
+        int count(int k) const;
+
+        double value(const vector<double> &values) const;
+        bool operator==(const Pattern &other) const;
+};
@@ -0,0 +1,74 @@
+#include "PatternBlock.h"
+
+#include <vector>
+
+using std::vector;
+
+PatternBlock::PatternBlock() : m_starts{0} {
+    // Do nothing
+}
+
+void PatternBlock::add(const Pattern &pattern) {
+    for (int k = 0; k < pattern.size(); k++) {
+        m_rows.push_back(pattern.item(k));
+        m_values.push_back(pattern.count(k));
+    }
+    m_starts.push_back(m_rows.size());
+}
+
+// Appends a copy of column c of other
+void PatternBlock::add(const PatternBlock &other, int c) {
+    for (int k = other.begin(c); k < other.end(c); k++) {
+        m_rows.push_back(other.m_rows[k]);
+        m_values.push_back(other.m_values[k]);
+    }
+    m_starts.push_back(m_rows.size());
+}
+
+// Removes all columns, keeping the allocated storage
+void PatternBlock::clear() {
+    m_starts.resize(1);
+    m_rows.clear();
+    m_values.clear();
+}
+
+int PatternBlock::size() const {
+    return m_starts.size() - 1;
+}
+
+int PatternBlock::nonzeros() const {
+    return m_rows.size();
+}
+
+int PatternBlock::begin(int c) const {
+    return m_starts[c];
+}
+
+int PatternBlock::end(int c) const {
+    return m_starts[c + 1];
+}
+
+const vector<int> &PatternBlock::rows() const {
+    return m_rows;
+}
+
+const vector<double> &PatternBlock::values() const {
+    return m_values;
+}
+
+Pattern PatternBlock::pattern(int c) const {
+    Pattern out;
+    for (int k = begin(c); k < end(c); k++) {
+        out.add(m_rows[k], m_values[k]);
+    }
+    return out;
+}
+
+// Total value of column c, given the value of each item (row)
+double PatternBlock::value(int c, const vector<double> &item_values) const {
+    double total = 0;
+    for (int k = begin(c); k < end(c); k++) {
+        total += item_values[m_rows[k]] * m_values[k];
+    }
+    return total;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+
+#include "Pattern.h"
+
+using std::vector;
+
+// A set of pattern columns stored contiguously in compressed sparse form.
+// The entries of column c are [begin(c), end(c)) in rows() and values(),
+// with 0-based row indices.
+class PatternBlock {
+    vector<int> m_starts;
+    vector<int> m_rows;
+    vector<double> m_values;
+
+    public:
+        PatternBlock();
+
+        void add(const Pattern &pattern);
+        void add(const PatternBlock &other, int c);
+        void clear();
+
+        int size() const;
+        int nonzeros() const;
+        int begin(int c) const;
+        int end(int c) const;
+        const vector<int> &rows() const;
+        const vector<double> &values() const;
+
+        Pattern pattern(int c) const;
+        double value(int c, const vector<double> &item_values) const;
+};
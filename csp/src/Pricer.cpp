@@ -0,0 +1,15 @@
+#include "Pricer.h"
+
+#include <vector>
+
+using std::vector;
+
+double Pricer::solveMany(const vector<double> &values, int k,
+        double threshold, vector<Pattern> &patterns) {
+    patterns.resize(1);
+    double value = solve(values, patterns[0]);
+    if (value <= threshold || k < 1) {
+        patterns.clear();
+    }
+    return value;
+}
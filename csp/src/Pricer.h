@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "Pattern.h"
+
+using std::vector;
+
+// Solver for the CSP pricing problem: given the dual values of the master
+// problem, finds the cutting pattern with the largest total value.
+class Pricer {
+    public:
+        virtual ~Pricer() {}
+
+        // Writes the best pattern to pattern and returns its value
+        virtual double solve(const vector<double> &values,
+                Pattern &pattern) = 0;
+
+        // Replaces the contents of patterns with up to k distinct patterns
+        // whose value is above threshold, best first, and returns the best
+        // value found. The default only yields the pattern from solve().
+        virtual double solveMany(const vector<double> &values, int k,
+                double threshold, vector<Pattern> &patterns);
+
+        // Prints solver-specific information (debug output only)
+        virtual void printInfo(std::ostream &) {}
+};
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
+using std::string;
 using std::vector;
 
 struct ProblemData {
@@ -10,3 +12,8 @@ struct ProblemData {
     vector<int> widths;
     vector<int> demands;
 };
+
+struct Instance {
+    string title;
+    ProblemData pd;
+};
@@ -0,0 +1,55 @@
+#include "ProblemReader.h"
+
+ProblemReader::ProblemReader(const string &path, const string &title)
+    : m_scanner(path), m_title(title), m_done(false), m_failed(false) {
+    m_multiple = m_scanner.peek() == '\'';
+    if (!m_scanner.valid()) {
+        m_done = true;
+        m_failed = true;
+    }
+}
+
+bool ProblemReader::multiple() const {
+    return m_multiple;
+}
+
+bool ProblemReader::good() const {
+    return !m_failed;
+}
+
+bool ProblemReader::next(Instance &instance) {
+    if (m_done || m_scanner.atEnd()) {
+        m_done = true;
+        return false;
+    }
+
+    ProblemData &pd = instance.pd;
+    bool ok;
+    if (m_multiple) {
+        // Title line, quotes stripped from both ends
+        string line = m_scanner.readLine();
+        size_t first = line.find_first_not_of('\'');
+        size_t last = line.find_last_not_of('\'');
+        instance.title = first == string::npos
+            ? "" : line.substr(first, last - first + 1);
+        ok = m_scanner.readInt(pd.cuts) && m_scanner.readInt(pd.stock_width);
+    } else {
+        instance.title = m_title;
+        ok = m_scanner.readInt(pd.stock_width) && m_scanner.readInt(pd.cuts);
+        m_done = true;
+    }
+
+    ok = ok && pd.cuts >= 0;
+    pd.widths.resize(ok ? pd.cuts : 0);
+    pd.demands.resize(ok ? pd.cuts : 0);
+    for (int i = 0; ok && i < pd.cuts; i++) {
+        ok = m_scanner.readInt(pd.widths[i])
+            && m_scanner.readInt(pd.demands[i]);
+    }
+
+    if (!ok) {
+        m_done = true;
+        m_failed = true;
+    }
+    return ok;
+}
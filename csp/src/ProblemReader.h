@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+#include "ProblemData.h"
+#include "Scanner.h"
+
+using std::string;
+
+// Streams the instances of a file one at a time. A file holds either a
+// single instance, headed by the stock width and then the number of cuts, or
+// several, each one preceded by its title in single quotes and headed by the
+// number of cuts and then the stock width.
+class ProblemReader {
+    Scanner m_scanner;
+    string m_title;
+    bool m_multiple;
+    bool m_done;
+    bool m_failed;
+
+    public:
+        // A single instance takes the given title
+        ProblemReader(const string &path, const string &title);
+
+        // True if the file holds titled instances
+        bool multiple() const;
+
+        // Reads the next instance, returning false at the end of the file
+        // or on a malformed instance
+        bool next(Instance &instance);
+
+        // False if the file could not be read, or an instance was malformed
+        bool good() const;
+};
@@ -1,11 +1,21 @@
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <cstring>
+#include <cstdlib>
+#include <cmath>
 #include <vector>
 
+#include <algorithm>
+#include <thread>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
 #include "ProblemData.h"
+#include "ProblemReader.h"
+#include "Options.h"
 #include "CSP.h"
+#include "Batch.h"
 
 using std::strcmp;
 using std::string;
@@ -13,50 +23,247 @@ using std::vector;
 using std::cout;
 
 
-ProblemData readProblemData(std::ifstream &file) {
-    ProblemData pd;
-    file >> pd.stock_width >> pd.cuts;
+string baseName(const string &path) {
+    size_t slash = path.rfind('/');
+    return slash == string::npos ? path : path.substr(slash + 1);
+}
 
-    for (int i = 0; i < pd.cuts; i++){
-        int width, demand;
-        file >> width >> demand;
-        pd.widths.push_back(width);
-        pd.demands.push_back(demand);
+// Appends every instance left in reader to instances. Instances after a
+// malformed one are skipped.
+void readInstances(ProblemReader &reader, const string &path,
+        vector<Instance> &instances) {
+    Instance instance;
+    while (reader.next(instance)) {
+        instances.push_back(instance);
     }
+    if (!reader.good()) {
+        cout << "ERROR: Could not read " << path << "\n";
+    }
+}
 
-    return pd;
+bool isDirectory(const char *path) {
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
 }
 
+// Instances of every file in a directory, files taken in name order. Files
+// which don't start with an instance, like the result files kept next to
+// the benchmark sets, are skipped.
+vector<Instance> readDirectory(const string &path, bool debug) {
+    vector<string> names;
+    DIR *dir = opendir(path.c_str());
+    if (dir != nullptr) {
+        while (dirent *entry = readdir(dir)) {
+            string name(entry->d_name);
+            string full = path + "/" + name;
+            if (name[0] != '.' && !isDirectory(full.c_str())) {
+                names.push_back(name);
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(names.begin(), names.end());
 
+    vector<Instance> instances;
+    for (const string &name : names) {
+        string full = path + "/" + name;
+        ProblemReader reader(full, name);
+        Instance first;
+        if (!reader.next(first)) {
+            if (debug) {
+                cout << "Skipping " << full << ": not an instance\n";
+            }
+            continue;
+        }
+        instances.push_back(first);
+        readInstances(reader, full, instances);
+    }
+    return instances;
+}
 
-void singleProblem(const char *path, bool debug) {
+void batchProblems(const vector<Instance> &instances, bool debug,
+        Options opts, int threads) {
+    if (debug) {
+        cout << "Read " << instances.size() << " instances, solving on "
+            << threads << " threads\n";
+    }
+
+    solveBatch(instances, opts, threads, debug);
+}
+
+void singleProblem(ProblemReader &reader, const char *path, bool debug,
+        Options opts) {
     if (debug) {
         string title = "Input file: ";
         title += string(path);
         cout << title << "\n";
     }
 
-    std::ifstream file(path);
-    ProblemData pd = readProblemData(file);
+    Instance instance;
+    if (!reader.next(instance)) {
+        cout << "ERROR: Could not read " << path << "\n";
+        return;
+    }
 
     if (debug) {
         cout << "Read!\n";
     }
 
-    string filename(std::strrchr(path, '/') + 1);
-
-    CSP csp(filename, pd);
+    CSP csp(instance.title, instance.pd, opts);
     csp.solve(debug);
 }
 
+// Parses a positive integer option value
+bool parsePositive(const string &value, int &out) {
+    char *end;
+    long parsed = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || parsed <= 0) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+// Parses a floating point option value in [low, high)
+bool parseRange(const string &value, double low, double high, double &out) {
+    char *end;
+    double parsed = std::strtod(value.c_str(), &end);
+    if (value.empty() || *end != '\0' || parsed < low || parsed >= high) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+// Parses a single "--name=value" argument into opts. Returns false if the
+// option is unknown or its value is invalid.
+bool parseOption(const string &arg, Options &opts) {
+    size_t eq = arg.find('=');
+    string name = arg.substr(2, eq == string::npos ? string::npos : eq - 2);
+    string value = eq == string::npos ? "" : arg.substr(eq + 1);
+
+    if (name == "pricing") {
+        if (value == "dense") {
+            opts.pricing = PricingMode::dense;
+        } else if (value == "reduced") {
+            opts.pricing = PricingMode::reduced;
+        } else if (value == "bb") {
+            opts.pricing = PricingMode::branch_bound;
+        } else {
+            return false;
+        }
+    } else if (name == "heuristic" && value.empty()) {
+        opts.heuristic = true;
+    } else if (name == "early-stop" && value.empty()) {
+        opts.early_stop = true;
+    } else if (name == "simplex") {
+        if (value == "warm") {
+            opts.warm_start = true;
+        } else if (value == "default") {
+            opts.warm_start = false;
+        } else {
+            return false;
+        }
+    } else if (name == "columns") {
+        return parsePositive(value, opts.columns);
+    } else if (name == "purge") {
+        return parsePositive(value, opts.purge_age);
+    } else if (name == "smoothing") {
+        return parseRange(value, 0, 1, opts.smoothing);
+    } else if (name == "box") {
+        return parseRange(value, 0, HUGE_VAL, opts.box);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void printUsage() {
+    cout << "Format: ./csp <input> [debug] [options]\n"
+        << "The input is an instance file, a file with several quoted "
+           "instances, or a\n"
+        << "directory of such files; the last two are solved in parallel.\n"
+        << "Options:\n"
+        << "  --threads=n                  worker threads for several "
+           "instances\n"
+        << "                               (default: all cores)\n"
+        << "  --pricing=dense|reduced|bb   pricing solver: dense DP, "
+           "reduced-capacity DP\n"
+        << "                               or branch-and-bound "
+           "(default: dense)\n"
+        << "  --heuristic                  try greedy pricing before the "
+           "exact pricer\n"
+        << "  --early-stop                 stop once the rounded up lower "
+           "bound meets\n"
+        << "                               the rounded up master objective\n"
+        << "  --columns=k                  add up to k improving patterns "
+           "per iteration\n"
+        << "                               (default: 1)\n"
+        << "  --simplex=warm|default       re-solve the master from the "
+           "previous basis,\n"
+        << "                               or with GLPK defaults "
+           "(default: warm)\n"
+        << "  --purge=n                    move columns non-basic with "
+           "positive reduced\n"
+        << "                               cost for over n iterations to "
+           "a pool\n"
+        << "  --smoothing=a                stabilize duals by mixing in "
+           "the stability\n"
+        << "                               center with weight a in [0, 1) "
+           "(default: 0)\n"
+        << "  --box=delta                  keep stabilized duals within "
+           "delta of the\n"
+        << "                               center (default: 0, no box)\n";
+}
+
 int main(int argc, char *argv[]) {
-    if (argc == 2) {
-        singleProblem(argv[1], false);
-    } else if (argc == 3) {
-        singleProblem(argv[1], true);
+    // Options may appear anywhere; the first other argument is the input
+    // file, and any argument after it turns on debug output
+    const char *path = nullptr;
+    bool debug = false;
+    Options opts;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int a = 1; a < argc; a++) {
+        string arg(argv[a]);
+        if (arg.compare(0, 10, "--threads=") == 0) {
+            if (!parsePositive(arg.substr(10), threads)) {
+                cout << "ERROR: Bad option " << arg << "\n";
+                printUsage();
+                return 0;
+            }
+        } else if (arg.compare(0, 2, "--") == 0) {
+            if (!parseOption(arg, opts)) {
+                cout << "ERROR: Bad option " << arg << "\n";
+                printUsage();
+                return 0;
+            }
+        } else if (path == nullptr) {
+            path = argv[a];
+        } else {
+            debug = true;
+        }
+    }
+
+    if (path == nullptr) {
+        cout << "ERROR: Bad input format\n";
+        printUsage();
+        return 0;
+    }
+
+    // A directory, or a file with several instances, is solved as a batch
+    if (isDirectory(path)) {
+        vector<Instance> instances = readDirectory(path, debug);
+        batchProblems(instances, debug, opts, threads);
+        return 0;
+    }
+
+    ProblemReader reader(path, baseName(path));
+    if (reader.multiple()) {
+        vector<Instance> instances;
+        readInstances(reader, path, instances);
+        batchProblems(instances, debug, opts, threads);
     } else {
-        cout << "ERROR: Bad input format\n"
-            << "Format: ./csp <input_file> [debug]\n";
+        singleProblem(reader, path, debug, opts);
     }
     return 0;
 }
@@ -0,0 +1,38 @@
+#! /bin/fish
+
+# Runs each instance file with the DP and the branch-and-bound pricers and
+# prints their results side by side, one row per instance, rows of the two
+# runs paired by title:
+# title & DP pricing time & B&B pricing time & DP objective & B&B objective
+
+set exe $argv[1]
+echo "Executable: $exe" 1>&2
+
+echo "Running: " 1>&2
+for arg in $argv[2..-1]
+    echo $exe \"$arg\" 1>&2
+    set dp_rows ($exe $arg --pricing=dense)
+    set bb_rows ($exe $arg --pricing=bb)
+
+    for dp_row in $dp_rows
+        set dp (string split " & " -- $dp_row)
+        # Not a summary row, like an error message
+        if test (count $dp) -lt 5
+            echo $dp_row 1>&2
+            continue
+        end
+
+        set found 0
+        for bb_row in $bb_rows
+            set bb (string split " & " -- $bb_row)
+            if test (count $bb) -ge 5; and test "$bb[1]" = "$dp[1]"
+                echo "$dp[1] & $dp[4] & $bb[4] & $dp[5] & $bb[5]"
+                set found 1
+                break
+            end
+        end
+        if test $found -eq 0
+            echo "No B&B result for $dp[1]" 1>&2
+        end
+    end
+end
@@ -0,0 +1,173 @@
+// Checks the closed-form uncapacitated subproblem against its LP. For each
+// customer and location vector y, the closed-form solution must be feasible
+// for the subproblem, v_j - w_ij <= c_ij with v_j, w_ij >= 0, and its cut
+//     sum_j v_j - sum_i y_i sum_j w_ij
+// must equal the LP optimum at y, so that the cut is tight there. Feasible
+// solutions give valid cuts everywhere else. Location vectors are integral
+// and fractional, over random costs and over costs with many ties, where
+// the subproblem's optimal solution is degenerate.
+//
+// Build: g++ closed_form.cpp ../src/ClosedFormSubproblem.cpp ../src/LPP.cpp
+//            -o closed_form -std=c++14 -lglpk
+// Usage: ./closed_form [seed]
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/ClosedFormSubproblem.h"
+#include "../src/FLPData.h"
+#include "../src/LPP.h"
+
+using std::string;
+using std::vector;
+using std::cout;
+
+const double TOLERANCE = 1e-7;
+
+FLPData randomData(int locations, int customers, int max_cost,
+        std::mt19937 &rng) {
+    std::uniform_int_distribution<int> cost(0, max_cost);
+    FLPData data;
+    data.locations = locations;
+    data.customers = customers;
+    data.supplies = vector<int>(locations, 1);
+    data.build_costs = vector<double>(locations, 0);
+    data.demands = vector<int>(customers, 1);
+    data.ship_costs.resize(locations * customers);
+    for (double &c : data.ship_costs) {
+        c = cost(rng);
+    }
+    return data;
+}
+
+// Customer j's subproblem as an LP: v_j, then w_ij for each location
+double customerLP(const FLPData &data, int j, const vector<double> &y) {
+    LPP lp(ObjDir::max);
+    lp.addCol(1, LPBounds::lower, 0, 0);
+    for (int i = 0; i < data.locations; i++) {
+        lp.addCol(-y[i], LPBounds::lower, 0, 0);
+    }
+    for (int i = 0; i < data.locations; i++) {
+        double cost = data.shipCost(i, j);
+        lp.addRow(LPBounds::upper, cost, cost);
+        lp.addConstrRow(vector<int>{0, i + 1}, vector<double>{1, -1});
+    }
+    lp.simplex();
+    return lp.objective();
+}
+
+// Checks one location vector, printing every failure. Returns the number
+// of failures.
+int check(const string &name, const FLPData &data, const vector<double> &y) {
+    ClosedFormSubproblem closed(data);
+    closed.solve(y);
+    const vector<double> &vars = closed.primalVars();
+
+    int failures = 0;
+    double total = 0;
+    for (int j = 0; j < data.customers; j++) {
+        double v = vars[j];
+        double cut = v;
+        bool feasible = v >= 0;
+        for (int i = 0; i < data.locations; i++) {
+            double w = vars[data.customers * (i + 1) + j];
+            feasible = feasible && w >= 0
+                && v - w <= data.shipCost(i, j) + TOLERANCE;
+            cut -= y[i] * w;
+        }
+        total += cut;
+
+        double optimum = customerLP(data, j, y);
+        if (!feasible || std::abs(cut - optimum) > TOLERANCE) {
+            cout << "FAILED " << name << ", customer " << j << ": "
+                << (feasible ? "" : "infeasible, ") << "cut " << cut
+                << ", LP " << optimum << "\n";
+            failures++;
+        }
+    }
+
+    if (std::abs(total - closed.objective()) > TOLERANCE) {
+        cout << "FAILED " << name << ": objective " << closed.objective()
+            << ", cuts add up to " << total << "\n";
+        failures++;
+    }
+    return failures;
+}
+
+// A random nonempty set of open locations
+vector<double> integerY(int locations, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> coin(0, 1);
+    vector<double> y(locations);
+    double sum = 0;
+    for (double &value : y) {
+        value = coin(rng);
+        sum += value;
+    }
+    if (sum == 0) {
+        y[rng() % locations] = 1;
+    }
+    return y;
+}
+
+// Random values in [0, 1] adding up to at least 1, as the master requires.
+// Some are 0 or 1, and with exact_cover they add up to exactly 1.
+vector<double> fractionalY(int locations, bool exact_cover,
+        std::mt19937 &rng) {
+    std::uniform_int_distribution<int> kind(0, 3);
+    std::uniform_real_distribution<double> fraction(0, 1);
+    vector<double> y(locations);
+    double sum = 0;
+    for (double &value : y) {
+        int k = kind(rng);
+        value = k == 0 ? 0 : k == 1 ? 1 : fraction(rng);
+        sum += value;
+    }
+    if (exact_cover || sum < 1) {
+        if (sum == 0) {
+            y[0] = 1;
+            sum = 1;
+        }
+        for (double &value : y) {
+            value /= sum;
+        }
+    }
+    return y;
+}
+
+int main(int argc, char *argv[]) {
+    std::mt19937 rng(argc > 1 ? std::atoi(argv[1]) : 1);
+    LPP::termOut(true);
+
+    int cases = 0;
+    int failures = 0;
+    for (int round = 0; round < 50; round++) {
+        // Few distinct costs make ties between locations common
+        bool ties = round % 2 == 0;
+        FLPData data = randomData(2 + round % 7, 1 + round % 5,
+                ties ? 3 : 1000, rng);
+        string name = "round " + std::to_string(round);
+
+        failures += check(name + ", integral", data,
+                integerY(data.locations, rng));
+        failures += check(name + ", fractional", data,
+                fractionalY(data.locations, false, rng));
+        failures += check(name + ", exact cover", data,
+                fractionalY(data.locations, true, rng));
+        cases += 3;
+    }
+
+    // Every cost equal: every location ties for every customer
+    FLPData flat = randomData(4, 3, 0, rng);
+    failures += check("equal costs, one open", flat, {0, 1, 0, 0});
+    failures += check("equal costs, all open", flat, {1, 1, 1, 1});
+    failures += check("equal costs, halves", flat, {0.5, 0, 0.5, 0});
+    cases += 3;
+
+    cout << cases << " location vectors checked, " << failures
+        << " failures\n";
+    return failures == 0 ? 0 : 1;
+}
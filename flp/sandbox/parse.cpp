@@ -0,0 +1,151 @@
+// Compares the stream based instance reader with the memory-mapped one.
+//
+// Build: g++ parse.cpp ../src/FLPReader.cpp ../../common/Scanner.cpp -o parse
+//            -I../../common -std=c++14 -O3
+// Usage: ./parse <instance> [repeats]
+//        ./parse --generate <locations> <customers> <output>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/FLPData.h"
+#include "../src/FLPReader.h"
+
+using std::string;
+using std::vector;
+using std::cout;
+
+// The reader main.cpp used before the mapped one, kept with its nested
+// per-location cost vectors
+struct StreamData {
+    int locations;
+    int customers;
+    vector<int> supplies;
+    vector<double> build_costs;
+    vector<int> demands;
+    vector<vector<double>> ship_costs;
+};
+
+StreamData readStream(const string &path) {
+    std::ifstream file(path);
+    StreamData data;
+
+    file >> data.locations >> data.customers;
+
+    for (int i = 0; i < data.locations; i++) {
+        int supply;
+        double build_cost;
+        file >> supply >> build_cost;
+        data.supplies.push_back(supply);
+        data.build_costs.push_back(build_cost);
+    }
+
+    data.ship_costs = vector<vector<double>>(data.locations, vector<double>{});
+
+    for (int j = 0; j < data.customers; j++) {
+        int demand;
+        file >> demand;
+        data.demands.push_back(demand);
+
+        for (int i = 0; i < data.locations; i++) {
+            double ship_cost;
+            file >> ship_cost;
+            data.ship_costs[i].push_back(ship_cost);
+        }
+    }
+
+    return data;
+}
+
+// Writes a random instance in the OR-Library format
+void generate(int locations, int customers, const string &path) {
+    std::mt19937 rng(locations * 7919 + customers);
+    std::uniform_int_distribution<int> supply(1000, 20000);
+    std::uniform_real_distribution<double> cost(0, 100000);
+    std::uniform_int_distribution<int> demand(1, 500);
+
+    std::ofstream file(path);
+    file.setf(std::ios::fixed);
+    file.precision(5);
+    file << " " << locations << " " << customers << " \n";
+    for (int i = 0; i < locations; i++) {
+        file << " " << supply(rng) << " " << cost(rng) << " \n";
+    }
+    for (int j = 0; j < customers; j++) {
+        file << " " << demand(rng) << " \n";
+        for (int i = 0; i < locations; i++) {
+            file << " " << cost(rng) / 10;
+            if (i % 7 == 6 || i == locations - 1) {
+                file << " \n";
+            }
+        }
+    }
+}
+
+bool same(const StreamData &a, const FLPData &b) {
+    if (a.locations != b.locations || a.customers != b.customers
+            || a.supplies != b.supplies || a.build_costs != b.build_costs
+            || a.demands != b.demands) {
+        return false;
+    }
+    for (int i = 0; i < a.locations; i++) {
+        for (int j = 0; j < a.customers; j++) {
+            if (a.ship_costs[i][j] != b.shipCost(i, j)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+double seconds(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 5 && string(argv[1]) == "--generate") {
+        generate(std::atoi(argv[2]), std::atoi(argv[3]), argv[4]);
+        return 0;
+    }
+    if (argc != 2 && argc != 3) {
+        cout << "ERROR: Bad input format\n";
+        return 0;
+    }
+
+    string path(argv[1]);
+    int repeats = argc == 3 ? std::atoi(argv[2]) : 5;
+    std::ifstream size_file(path, std::ios::ate | std::ios::binary);
+    double megabytes = size_file.tellg() / 1e6;
+
+    StreamData stream;
+    FLPData mapped;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        stream = readStream(path);
+    }
+    double stream_time = seconds(start) / repeats;
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        if (!readFLPData(path, mapped)) {
+            cout << "ERROR: Could not read " << path << "\n";
+            return 0;
+        }
+    }
+    double mapped_time = seconds(start) / repeats;
+
+    cout << "Instance: " << path << " (" << megabytes << " MB)\n"
+        << "Stream: " << stream_time << " s, "
+        << megabytes / stream_time << " MB/s\n"
+        << "Mapped: " << mapped_time << " s, "
+        << megabytes / mapped_time << " MB/s\n"
+        << "Same data: " << (same(stream, mapped) ? "yes" : "NO") << "\n";
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "ClosedFormSubproblem.h"
+
+#include <algorithm>
+#include <numeric>
+
+// Tolerance on the y_i adding up to 1, for fractional masters
+const double COVER_TOLERANCE = 1e-9;
+
+ClosedFormSubproblem::ClosedFormSubproblem(const FLPData &data)
+    : data(data), order(data.customers * data.locations),
+      sorted_costs(data.customers * data.locations),
+      vars((data.locations + 1) * data.customers, 0), total(0) {
+    int n = data.locations;
+    for (int j = 0; j < data.customers; j++) {
+        int *locations = &order[j * n];
+        std::iota(locations, locations + n, 0);
+        std::stable_sort(locations, locations + n, [&](int a, int b) {
+            return data.shipCost(a, j) < data.shipCost(b, j);
+        });
+        for (int k = 0; k < n; k++) {
+            sorted_costs[j * n + k] = data.shipCost(locations[k], j);
+        }
+    }
+}
+
+void ClosedFormSubproblem::solve(const vector<double> &built) {
+    int n = data.locations;
+    std::fill(vars.begin() + data.customers, vars.end(), 0);
+    total = 0;
+
+    for (int j = 0; j < data.customers; j++) {
+        const int *locations = &order[j * n];
+        const double *costs = &sorted_costs[j * n];
+
+        // First location where the y_i so far cover the customer
+        int last = 0;
+        double covered = built[locations[0]];
+        while (covered < 1 - COVER_TOLERANCE && last < n - 1) {
+            last++;
+            covered += built[locations[last]];
+        }
+
+        double v = costs[last];
+        double objective = v;
+        for (int k = 0; k < last; k++) {
+            double w = v - costs[k];
+            vars[data.customers * (locations[k] + 1) + j] = w;
+            objective -= built[locations[k]] * w;
+        }
+        vars[j] = v;
+        total += objective;
+    }
+}
+
+double ClosedFormSubproblem::objective() {
+    return total;
+}
+
+const vector<double> &ClosedFormSubproblem::primalVars() {
+    return vars;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+#include "FLPData.h"
+
+using std::vector;
+
+// The uncapacitated subproblem solved without an LP. For customer j,
+//     max v_j - sum_i y_i w_ij  s.t.  v_j - w_ij <= c_ij,  v_j, w_ij >= 0
+// takes w_ij = max(0, v_j - c_ij), leaving a concave function of v_j whose
+// slope drops by y_i at each c_ij. Its maximum is at the first cost, in
+// increasing order, where the y_i of the locations so far add up to 1: the
+// cheapest open location's cost when y is integral. Locations are sorted
+// by cost once per customer, so each solve is a scan of those lists.
+class ClosedFormSubproblem {
+    const FLPData &data;
+
+    // Per customer, its locations by increasing cost, and those costs
+    vector<int> order;
+    vector<double> sorted_costs;
+
+    // v_j for every customer, then w_ij for every location and customer,
+    // laid out like the monolithic subproblem's columns
+    vector<double> vars;
+    double total;
+
+    public:
+        ClosedFormSubproblem(const FLPData &data);
+
+        // y must add up to at least 1, as the master requires
+        void solve(const vector<double> &built);
+
+        // Sum of the customers' objectives, without build costs
+        double objective();
+
+        // Solution in the monolithic subproblem's column layout
+        const vector<double> &primalVars();
+};
@@ -0,0 +1,145 @@
+#include "CustomerSubproblems.h"
+
+#include <glpk.h>
+#include <algorithm>
+#include <utility>
+
+CustomerSubproblems::CustomerSubproblems(const FLPData &data, int threads)
+    : data(data), vars((data.locations + 1) * data.customers, 0),
+      objectives(data.customers, 0), round_built(nullptr), round(0),
+      pending(0), stopping(false) {
+    // GLPK can only be used from several threads when its environment is
+    // thread-local
+    if (glp_config("TLS") == NULL) {
+        threads = 1;
+    }
+    threads = std::max(1, std::min(threads, data.customers));
+
+    for (int t = 0; t < threads; t++) {
+        Range range;
+        range.first = data.customers * t / threads;
+        range.last = data.customers * (t + 1) / threads;
+        ranges.push_back(std::move(range));
+    }
+
+    // A single range is solved by the calling thread
+    if (threads > 1) {
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back(&CustomerSubproblems::work, this, t);
+        }
+    }
+}
+
+CustomerSubproblems::~CustomerSubproblems() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+LPP CustomerSubproblems::buildCustomer(int j, const vector<double> &built) {
+    LPP lp(ObjDir::max);
+
+    lp.addCol(1, LPBounds::lower, 0, 0); // v_j
+    for (int i = 0; i < data.locations; i++) {
+        lp.addCol(-built[i], LPBounds::lower, 0, 0); // w_ij
+    }
+
+    // v_j - w_ij <= c_ij, one per location
+    vector<int> indices(2);
+    vector<double> values{1, -1};
+    for (int i = 0; i < data.locations; i++) {
+        double cost = data.shipCost(i, j);
+        lp.addRow(LPBounds::upper, cost, cost);
+        indices[0] = 0;
+        indices[1] = i + 1;
+        lp.addConstrRow(indices, values);
+    }
+
+    return lp;
+}
+
+void CustomerSubproblems::solveRange(Range &range,
+        const vector<double> &built) {
+    if (range.lps.empty()) {
+        for (int j = range.first; j < range.last; j++) {
+            range.lps.emplace_back(new LPP(buildCustomer(j, built)));
+        }
+        range.built = built;
+    }
+
+    vector<double> primal;
+    for (int j = range.first; j < range.last; j++) {
+        LPP &lp = *range.lps[j - range.first];
+        for (int i = 0; i < data.locations; i++) {
+            if (range.built[i] != built[i]) {
+                lp.setObjCoef(i + 1, -built[i]);
+            }
+        }
+        lp.reoptimize();
+
+        objectives[j] = lp.objective();
+        lp.primalVars(primal);
+        vars[j] = primal[0];
+        for (int i = 0; i < data.locations; i++) {
+            vars[data.customers * (i + 1) + j] = primal[i + 1];
+        }
+    }
+    range.built = built;
+}
+
+// Worker loop: solves its range once per round, until stopped
+void CustomerSubproblems::work(int worker) {
+    int seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start.wait(lock, [&] { return stopping || round != seen; });
+            if (stopping) {
+                break;
+            }
+            seen = round;
+        }
+
+        solveRange(ranges[worker], *round_built);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            done.notify_one();
+        }
+    }
+
+    // The LPs belong to this thread's GLPK environment
+    ranges[worker].lps.clear();
+    glp_free_env();
+}
+
+void CustomerSubproblems::solve(const vector<double> &built) {
+    if (workers.empty()) {
+        solveRange(ranges[0], built);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    round_built = &built;
+    pending = workers.size();
+    round++;
+    start.notify_all();
+    done.wait(lock, [this] { return pending == 0; });
+}
+
+double CustomerSubproblems::objective() {
+    double sum = 0;
+    for (double objective : objectives) {
+        sum += objective;
+    }
+    return sum;
+}
+
+const vector<double> &CustomerSubproblems::primalVars() {
+    return vars;
+}
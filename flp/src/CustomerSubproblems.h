@@ -0,0 +1,65 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "FLPData.h"
+#include "LPP.h"
+
+using std::vector;
+
+// The uncapacitated Benders subproblem for fixed built locations separates
+// by customer: customer j contributes
+//     max v_j - sum_i y_i w_ij  s.t.  v_j - w_ij <= c_ij,  v_j, w_ij >= 0
+// Each customer gets its own small LP, built once and then updated and
+// re-solved from its previous basis, like the monolithic subproblem.
+// Customers are split into contiguous ranges, one per worker thread. Each
+// worker creates, solves and deletes its own LPs, since GLPK objects are
+// tied to the thread-local environment of the thread which created them.
+class CustomerSubproblems {
+    // The LPs of a range of customers, and the locations they're set for
+    struct Range {
+        int first, last;
+        vector<std::unique_ptr<LPP>> lps;
+        vector<double> built;
+    };
+
+    const FLPData &data;
+    vector<Range> ranges;
+
+    // v_j for every customer, then w_ij for every location and customer,
+    // laid out like the monolithic subproblem's columns
+    vector<double> vars;
+    vector<double> objectives; // per customer
+
+    // Round handed to the workers, and the locations it is for
+    vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable start, done;
+    const vector<double> *round_built;
+    int round;
+    int pending;
+    bool stopping;
+
+    LPP buildCustomer(int j, const vector<double> &built);
+    void solveRange(Range &range, const vector<double> &built);
+    void work(int worker);
+
+    public:
+        CustomerSubproblems(const FLPData &data, int threads);
+        ~CustomerSubproblems();
+
+        CustomerSubproblems(const CustomerSubproblems &) = delete;
+        CustomerSubproblems &operator=(const CustomerSubproblems &) = delete;
+
+        void solve(const vector<double> &built);
+
+        // Sum of the customers' objectives, without build costs
+        double objective();
+
+        // Solution in the monolithic subproblem's column layout
+        const vector<double> &primalVars();
+};
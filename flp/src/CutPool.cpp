@@ -0,0 +1,156 @@
+#include "CutPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// Coefficients closer than this are the same for deduplication
+const double CUT_RESOLUTION = 1e-6;
+
+CutPool::CutPool(int max_idle)
+    : max_idle(max_idle), lazy(false), duplicates(0), dropped(0), restored(0) {}
+
+long long CutPool::quantize(double value) {
+    return std::llround(value / CUT_RESOLUTION);
+}
+
+size_t CutPool::hash(const vector<int> &indices,
+        const vector<double> &values, double constant) {
+    std::hash<long long> hasher;
+    size_t key = hasher(quantize(constant));
+    for (size_t k = 0; k < indices.size(); k++) {
+        // Mixing as in boost::hash_combine
+        key ^= hasher(indices[k]) + 0x9e3779b9 + (key << 6) + (key >> 2);
+        key ^= hasher(quantize(values[k])) + 0x9e3779b9
+            + (key << 6) + (key >> 2);
+    }
+    return key;
+}
+
+// Index of the cut equal to the given one, or -1
+int CutPool::find(const vector<int> &indices, const vector<double> &values,
+        double constant, size_t key) {
+    auto range = hashes.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Cut &cut = cuts[it->second];
+        if (cut.indices != indices
+                || quantize(cut.constant) != quantize(constant)) {
+            continue;
+        }
+        bool same = true;
+        for (size_t k = 0; k < values.size() && same; k++) {
+            same = quantize(cut.values[k]) == quantize(values[k]);
+        }
+        if (same) {
+            return it->second;
+        }
+    }
+    return -1;
+}
+
+double CutPool::slack(const Cut &cut, const vector<double> &x) {
+    double lhs = 0;
+    for (size_t k = 0; k < cut.indices.size(); k++) {
+        lhs += cut.values[k] * x[cut.indices[k]];
+    }
+    return lhs - cut.constant;
+}
+
+// Slack within which a cut counts as tight
+double CutPool::tolerance(const Cut &cut) {
+    return CUT_RESOLUTION * std::max(1., std::abs(cut.constant));
+}
+
+void CutPool::insert(LPP &master, Cut &cut) {
+    master.addRow(LPBounds::lower, cut.constant, cut.constant);
+    master.addConstrRow(cut.indices, cut.values);
+    if (!lazy) {
+        cut.row = master.rowCount() - 1;
+        cut.idle = 0;
+    }
+}
+
+bool CutPool::add(LPP &master, const vector<int> &indices,
+        const vector<double> &values, double constant) {
+    size_t key = hash(indices, values, constant);
+    int index = find(indices, values, constant, key);
+    if (index != -1) {
+        if (cuts[index].row != -1) {
+            duplicates++;
+            return false;
+        }
+        insert(master, cuts[index]);
+        if (!lazy) {
+            cuts[index].kept = true;
+            restored++;
+        }
+        return true;
+    }
+
+    cuts.push_back(Cut{indices, values, constant, -1, 0, false});
+    hashes.emplace(key, cuts.size() - 1);
+    insert(master, cuts.back());
+    return true;
+}
+
+void CutPool::age(LPP &master, const vector<double> &x) {
+    if (max_idle == 0) {
+        return;
+    }
+
+    vector<int> rows;
+    for (Cut &cut : cuts) {
+        if (cut.row == -1 || cut.kept) {
+            continue;
+        }
+        cut.idle = slack(cut, x) > tolerance(cut) ? cut.idle + 1 : 0;
+        if (cut.idle >= max_idle) {
+            rows.push_back(cut.row);
+            cut.row = -1;
+        }
+    }
+    if (rows.empty()) {
+        return;
+    }
+
+    // Every row after a deleted one moves up
+    master.deleteRows(rows);
+    std::sort(rows.begin(), rows.end());
+    for (Cut &cut : cuts) {
+        if (cut.row != -1) {
+            cut.row -= std::lower_bound(rows.begin(), rows.end(), cut.row)
+                - rows.begin();
+        }
+    }
+    dropped += rows.size();
+}
+
+int CutPool::restore(LPP &master, const vector<double> &x) {
+    int count = 0;
+    for (Cut &cut : cuts) {
+        if (cut.row != -1) {
+            continue;
+        }
+        if (slack(cut, x) < -tolerance(cut)) {
+            insert(master, cut);
+            cut.kept = true;
+            count++;
+        }
+    }
+    restored += count;
+    return count;
+}
+
+void CutPool::setLazy(bool lazy) {
+    this->lazy = lazy;
+}
+
+int CutPool::active() {
+    int count = 0;
+    for (const Cut &cut : cuts) {
+        if (cut.row != -1) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "LPP.h"
+
+using std::vector;
+
+// Every Benders cut found for a master, as the sparse row
+//     sum_k values[k] x[indices[k]] >= constant
+// A cut equal to one already in the pool is not added again. Cuts whose
+// slack stays positive for max_idle master solutions in a row are deleted
+// from the master, but stay in the pool: they are added back as soon as a
+// master solution violates them, before the subproblem is solved again.
+// A cut added back is never dropped again, so that dropping cuts can't make
+// the decomposition cycle. Inside GLPK's search tree, cuts are added as
+// lazy rows, which the search deletes with the subtree that added them, so
+// the pool does not track their rows there.
+class CutPool {
+    struct Cut {
+        vector<int> indices;
+        vector<double> values;
+        double constant;
+        int row;  // in the master, -1 if dropped
+        int idle; // master solutions in a row with the cut slack
+        bool kept; // added back after being dropped
+    };
+
+    vector<Cut> cuts;
+    std::unordered_multimap<size_t, int> hashes; // to cuts
+    int max_idle;
+    bool lazy;
+
+    static long long quantize(double value);
+    static size_t hash(const vector<int> &indices,
+            const vector<double> &values, double constant);
+    int find(const vector<int> &indices, const vector<double> &values,
+            double constant, size_t key);
+    double slack(const Cut &cut, const vector<double> &x);
+    static double tolerance(const Cut &cut);
+    void insert(LPP &master, Cut &cut);
+
+    public:
+        int duplicates;
+        int dropped;
+        int restored;
+
+        // max_idle 0 keeps every cut in the master
+        CutPool(int max_idle);
+
+        // Adds a cut to the master, unless it is already in it. A dropped
+        // copy is added back instead. Returns false for a duplicate.
+        bool add(LPP &master, const vector<int> &indices,
+                const vector<double> &values, double constant);
+
+        // Counts one more master solution x for the idle cuts, and deletes
+        // the ones idle for too long from the master
+        void age(LPP &master, const vector<double> &x);
+
+        // Adds back the dropped cuts that x violates, returning how many
+        int restore(LPP &master, const vector<double> &x);
+
+        // While lazy, added cuts stay dropped in the pool: duplicates are
+        // only checked against the rows added before
+        void setLazy(bool lazy);
+
+        // Cuts currently in the master
+        int active();
+};
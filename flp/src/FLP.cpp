@@ -1,11 +1,16 @@
 #include "FLP.h"
 #include "FLPData.h"
+#include "CustomerSubproblems.h"
 #include "utility.h"
 
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <limits>
+#include <algorithm>
+#include <memory>
+#include <utility>
 
 #include <cmath>
 #include <ctime>
@@ -19,13 +24,24 @@ using std::numeric_limits;
 
 const double PRECISION = 0.001;
 
-const bool CAPACITATED = true;
+// Wall clock time, since subproblems may be solved on several threads
+double wallTime() {
+    std::chrono::duration<double> now =
+        std::chrono::steady_clock::now().time_since_epoch();
+    return now.count();
+}
 
-FLP::FLP(string title, FLPData data) : title(title), data(data) {
-    // Do nothing
+template<typename Model>
+FLP<Model>::FLP(string title, FLPData data, Options opts)
+    : title(title), data(std::move(data)), opts(opts) {
+    // Only the capacitated model reads the demand-scaled costs
+    if (Model::capacitated) {
+        this->data.scaleCosts();
+    }
 }
 
-void FLP::printProblemData() {
+template<typename Model>
+void FLP<Model>::printProblemData() {
     cout << data.locations << " locations, "
         << data.customers << " customers\n";
 
@@ -36,7 +52,7 @@ void FLP::printProblemData() {
 
         cout << "Shipping costs:\n";
         for (int j = 0; j < data.customers; j++) {
-            cout << j << ": " << data.ship_costs[i][j];
+            cout << j << ": " << data.shipCost(i, j);
             if (j % 6 == 5) {
                 cout << "\n";
             } else {
@@ -58,7 +74,12 @@ void FLP::printProblemData() {
     cout << "\n\n";
 }
 
-LPP FLP::initializeMaster() {
+// Master over z_0 and the y_i. With multi_cut, the master also has one
+// column theta_j per customer, bounding customer j's ship cost from below
+// through per-customer cuts, and z_0 is tied to the build costs plus the sum
+// of the theta_j.
+template<typename Model>
+LPP FLP<Model>::initializeMaster(bool multi_cut) {
     LPP master(ObjDir::min);
 
     master.addCol(1, LPBounds::free, 0, 0); // z_0 (objective)
@@ -67,18 +88,25 @@ LPP FLP::initializeMaster() {
         master.addBinaryCol(0); // y_i
     }
 
+    if (multi_cut) {
+        for (int j = 0; j < data.customers; j++) {
+            master.addCol(0, LPBounds::free, 0, 0); // theta_j
+        }
+    }
+    int columns = 1 + data.locations + (multi_cut ? data.customers : 0);
+
     // y_0 + y_1 + ... + y_i >= 1
     master.addRow(LPBounds::lower, 1, 1);
 
-    vector<double> constraint_row{0}; // 0*z_0
+    vector<double> constraint_row(columns, 0); // 0*z_0
 
     for (int i = 0; i < data.locations; i++) {
-        constraint_row.push_back(1); // 1 for each y_i
+        constraint_row[i + 1] = 1; // 1 for each y_i
     }
 
     master.addConstrRow(constraint_row);
 
-    if (CAPACITATED) {
+    if (Model::capacitated) {
         // Capacity constraint: there must be enough capacity for the required
         // demand
         double total_demand = 0;
@@ -86,16 +114,28 @@ LPP FLP::initializeMaster() {
             total_demand += demand;
         }
         master.addRow(LPBounds::lower, total_demand, total_demand);
-        vector<double> cap_row{0};
-        cap_row.insert(cap_row.end(), data.supplies.begin(),
-                data.supplies.end());
+        vector<double> cap_row(columns, 0);
+        std::copy(data.supplies.begin(), data.supplies.end(),
+                cap_row.begin() + 1);
         master.addConstrRow(cap_row);
     }
 
+    if (multi_cut) {
+        // z_0 - sum_i f_i y_i - sum_j theta_j = 0
+        master.addRow(LPBounds::fixed, 0, 0);
+        vector<double> link_row(columns, -1);
+        link_row[0] = 1;
+        for (int i = 0; i < data.locations; i++) {
+            link_row[i + 1] = -data.build_costs[i];
+        }
+        master.addConstrRow(link_row);
+    }
+
     return master;
 }
 
-double FLP::totalBuildCost(vector<int> built_locations) {
+template<typename Model>
+double FLP<Model>::totalBuildCost(const vector<double> &built_locations) {
     double total_build_cost = 0;
     for (int i = 0; i < data.locations; i++) {
         total_build_cost += data.build_costs[i] * built_locations[i];
@@ -103,7 +143,24 @@ double FLP::totalBuildCost(vector<int> built_locations) {
     return total_build_cost;
 }
 
-LPP FLP::initializeSub(vector<int> built_locations) {
+// Objective coefficient of the beta column: the supply of every built
+// location minus the sum of all demands. Locations may be fractionally
+// built, as in a core point.
+template<typename Model>
+template<typename T>
+double FLP<Model>::betaObjective(const vector<T> &built_locations) {
+    double beta_obj = 0;
+    for (double demand : data.demands) {
+        beta_obj -= demand;
+    }
+    for (int i = 0; i < data.locations; i++) {
+        beta_obj += data.supplies[i] * built_locations[i];
+    }
+    return beta_obj;
+}
+
+template<typename Model>
+LPP FLP<Model>::initializeSub(const vector<double> &built_locations) {
 
     LPP sub(ObjDir::max);
     sub.setConstantTerm(totalBuildCost(built_locations));
@@ -121,7 +178,7 @@ LPP FLP::initializeSub(vector<int> built_locations) {
         }
     }
 
-    if (CAPACITATED) {
+    if (Model::capacitated) {
         // Initialize alpha_i columns: one per location
         // value equals supply for that i
         for (int i = 0; i < data.locations; i++) {
@@ -131,43 +188,30 @@ LPP FLP::initializeSub(vector<int> built_locations) {
         // Initialize beta column
         // value equals the sum of all demands minus the supply for every
         // built location
-        double beta_obj = 0;
-        for (double demand : data.demands) {
-            beta_obj -= demand;
-        }
-        for (int i = 0; i < data.locations; i++) {
-            if (built_locations[i]) {
-                beta_obj += data.supplies[i];
-            }
-        }
-        sub.addCol(beta_obj, LPBounds::lower, 0, 0);
+        sub.addCol(betaObjective(built_locations), LPBounds::lower, 0, 0);
     }
 
     // n * m constraints, for each c
     // v_i - w_ij <= cij (not capacitated)
     // v_i - w_ij + alpha_i < cij (capacitated)
+    // Only the 2 or 3 nonzero coefficients of each row are stored.
+    int alpha_offset = data.customers * (data.locations + 1);
+    vector<int> indices;
+    vector<double> values;
     for (int i = 0; i < data.locations; i++) {
         for (int j = 0; j < data.customers; j++) {
-            double cost = data.ship_costs[i][j];
-            if (CAPACITATED) {
-                cost *= data.demands[j];
-            }
+            double cost = Model::cost(data, i, j);
 
             sub.addRow(LPBounds::upper, cost, cost);
 
             // v[m], w[n][m]
-            int columns = (data.locations + 1) * data.customers;
-            if (CAPACITATED) {
-                columns += data.locations + 1; // alpha[n] + beta[1]
-            }
-
-            vector<double> row(columns, 0);
-            row[j] = 1;
-            row[data.customers * (i + 1) + j] = -1;
-            if (CAPACITATED) {
-                row[data.customers * (data.locations + 1) + i] = 1;
+            indices = {j, data.customers * (i + 1) + j};
+            values = {1, -1};
+            if (Model::capacitated) {
+                indices.push_back(alpha_offset + i); // alpha[n]
+                values.push_back(1);
             }
-            sub.addConstrRow(row);
+            sub.addConstrRow(indices, values);
         }
     }
 
@@ -175,7 +219,9 @@ LPP FLP::initializeSub(vector<int> built_locations) {
 }
 
 
-LPP FLP::initializeRayGen(vector<int> built_locations, double upper_bound) {
+template<typename Model>
+LPP FLP<Model>::initializeRayGen(const vector<double> &built_locations,
+        double upper_bound) {
     LPP ray(ObjDir::max);
 
     // Initialize v_j columns: one per customer, all ones in objective
@@ -192,7 +238,7 @@ LPP FLP::initializeRayGen(vector<int> built_locations, double upper_bound) {
         }
     }
 
-    if (CAPACITATED) {
+    if (Model::capacitated) {
         // Initialize alpha_i columns: one per location
         // value equals supply for that i
         for (int i = 0; i < data.locations; i++) {
@@ -203,48 +249,39 @@ LPP FLP::initializeRayGen(vector<int> built_locations, double upper_bound) {
         // Initialize beta column
         // value equals the sum of all demands minus the supply for every
         // built location
-        double beta_obj = 0;
-        for (double demand : data.demands) {
-            beta_obj -= demand;
-        }
-        for (int i = 0; i < data.locations; i++) {
-            if (built_locations[i]) {
-                beta_obj += data.supplies[i];
-            }
-        }
-        ray.addCol(beta_obj, LPBounds::double_bound, 0, upper_bound);
+        ray.addCol(betaObjective(built_locations), LPBounds::double_bound, 0, upper_bound);
     }
 
     // n * m constraints, for each c
     // v_i - w_ij <= cost (not capacitated)
     // v_i - w_ij + alpha_i <= cost (capacitated)
+    int alpha_offset = data.customers * (data.locations + 1);
+    vector<int> indices;
+    vector<double> values;
     for (int i = 0; i < data.locations; i++) {
         for (int j = 0; j < data.customers; j++) {
             double cost = 0;
             ray.addRow(LPBounds::upper, cost, cost);
 
             // v[m], w[n][m]
-            int columns = (data.locations + 1) * data.customers;
-            if (CAPACITATED) {
-                columns += data.locations + 1; // alpha[n] + beta[1]
-            }
-
-            vector<double> row(columns, 0);
-            row[j] = 1;
-            row[data.customers * (i + 1) + j] = -1;
-            if (CAPACITATED) {
-                row[data.customers * (data.locations + 1) + i] = 1;
+            indices = {j, data.customers * (i + 1) + j};
+            values = {1, -1};
+            if (Model::capacitated) {
+                indices.push_back(alpha_offset + i); // alpha[n]
+                values.push_back(1);
             }
-            ray.addConstrRow(row);
+            ray.addConstrRow(indices, values);
         }
     }
 
     return ray;
 }
 
-vector<double> FLP::constraintFromSub(LPP &sub, bool extreme_ray) {
-    vector<double> sub_vars = sub.primalVars();
-
+// The cut's y_i coefficients, from the subproblem's (or extreme ray LP's)
+// solution in its column layout
+template<typename Model>
+vector<double> FLP<Model>::constraintFromSub(const vector<double> &sub_vars,
+        bool extreme_ray) {
     // w_ij - one for each location-customer pair
     vector<double> setup_vars(sub_vars.begin() + data.customers,
             sub_vars.begin() + data.customers * (data.locations + 1));
@@ -252,7 +289,7 @@ vector<double> FLP::constraintFromSub(LPP &sub, bool extreme_ray) {
     vector<double> constraint_row{extreme_ray ? 0. : 1.}; // z
 
     double supply_demand_var;
-    if (CAPACITATED){
+    if (Model::capacitated) {
         supply_demand_var = sub_vars.back(); // beta
     }
 
@@ -262,7 +299,7 @@ vector<double> FLP::constraintFromSub(LPP &sub, bool extreme_ray) {
             coef -= setup_vars[i * data.customers + j];
         }
 
-        if (CAPACITATED) {
+        if (Model::capacitated) {
             coef += data.supplies[i] * supply_demand_var;
         }
 
@@ -273,16 +310,15 @@ vector<double> FLP::constraintFromSub(LPP &sub, bool extreme_ray) {
     return constraint_row;
 }
 
-double FLP::constraintConstantFromSub(LPP &sub) {
-    vector<double> sub_vars = sub.primalVars();
-
+template<typename Model>
+double FLP<Model>::constraintConstantFromSub(const vector<double> &sub_vars) {
     // v_j - one for each customer
     vector<double> demand_vars(sub_vars.begin(),
             sub_vars.begin() + data.customers);
 
     vector<double> supply_vars; // alpha[n]
     double supply_demand_var; // beta
-    if (CAPACITATED) {
+    if (Model::capacitated) {
         auto begin = sub_vars.begin() +
             data.customers * (data.locations + 1);
         auto end = begin + data.locations;
@@ -295,7 +331,7 @@ double FLP::constraintConstantFromSub(LPP &sub) {
         sum += demand;
     }
 
-    if (CAPACITATED) {
+    if (Model::capacitated) {
         for (int i = 0; i < data.locations; i++) {
             sum += data.supplies[i] * supply_vars[i];
         }
@@ -310,49 +346,446 @@ double FLP::constraintConstantFromSub(LPP &sub) {
     return sum;
 }
 
-void FLP::updateSubLocations(LPP &sub, vector<int> built_locations) {
-    sub.setConstantTerm(totalBuildCost(built_locations));
+// Moves a subproblem or extreme ray LP, built for the locations in
+// previous, to the locations in built. Only the objective depends on them:
+// the w_ij columns of every location whose state changed, and beta. The
+// constant term is left to the caller.
+template<typename Model>
+void FLP<Model>::updateSubLocations(LPP &sub, const vector<double> &previous,
+        const vector<double> &built) {
+    if (previous == built) {
+        return;
+    }
+
+    for (int i = 0; i < data.locations; i++) {
+        if (previous[i] != built[i]) {
+            for (int j = 0; j < data.customers; j++) {
+                sub.setObjCoef(data.customers * (i + 1) + j, -built[i]);
+            }
+        }
+    }
+
+    if (Model::capacitated) {
+        int beta = data.customers * (data.locations + 1) + data.locations;
+        sub.setObjCoef(beta, betaObjective(built));
+    }
+}
+
+// Sets a subproblem's objective to its value at a possibly fractional y,
+// leaving out the constant term
+template<typename Model>
+void FLP<Model>::setSubObjective(LPP &sub, const vector<double> &y) {
     for (int i = 0; i < data.locations; i++) {
         for (int j = 0; j < data.customers; j++) {
-            // The first term below is the offset for the first m constraints
-            int constraint = data.customers + j + i * data.customers;
-            int built = built_locations[i];
-            sub.setRowBounds(constraint, LPBounds::upper, built, built);
+            sub.setObjCoef(data.customers * (i + 1) + j, -y[i]);
+        }
+    }
+
+    if (Model::capacitated) {
+        int beta = data.customers * (data.locations + 1) + data.locations;
+        sub.setObjCoef(beta, betaObjective(y));
+    }
+}
+
+// Magnanti-Wong LP: the subproblem, with its objective taken at a core
+// point, plus a last row keeping its solution optimal for the current built
+// locations. The row's coefficients are set on each cycle.
+template<typename Model>
+LPP FLP<Model>::initializeParetoSub() {
+    LPP pareto = initializeSub(vector<double>(data.locations, 0));
+    pareto.addRow(LPBounds::lower, 0, 0);
+    pareto.addConstrRow(vector<int>{0}, vector<double>{1});
+    return pareto;
+}
+
+// Replaces the subproblem solution in sub_vars, optimal for the built
+// locations with value sub_value (without build costs), by the optimal
+// solution with the best value at the core point. Its cut is then as
+// strong as any other at built, and stronger elsewhere.
+template<typename Model>
+void FLP<Model>::paretoSolution(LPP &pareto, const vector<double> &core,
+        const vector<double> &built, double sub_value,
+        vector<double> &sub_vars) {
+    setSubObjective(pareto, core);
+
+    // Subproblem objective at built >= sub_value
+    vector<int> indices;
+    vector<double> values;
+    for (int j = 0; j < data.customers; j++) {
+        indices.push_back(j); // v_j
+        values.push_back(1);
+    }
+    for (int i = 0; i < data.locations; i++) {
+        if (built[i] != 0) {
+            for (int j = 0; j < data.customers; j++) {
+                indices.push_back(data.customers * (i + 1) + j); // w_ij
+                values.push_back(-built[i]);
+            }
+        }
+    }
+    if (Model::capacitated) {
+        int alpha = data.customers * (data.locations + 1);
+        for (int i = 0; i < data.locations; i++) {
+            indices.push_back(alpha + i);
+            values.push_back(data.supplies[i]);
+        }
+        indices.push_back(alpha + data.locations); // beta
+        values.push_back(betaObjective(built));
+    }
+
+    int row = data.locations * data.customers;
+    pareto.setConstrRow(row, indices, values);
+    double tolerance = 1e-6 * std::max(1., abs(sub_value));
+    pareto.setRowBounds(row, LPBounds::lower, sub_value - tolerance, 0);
+
+    pareto.reoptimize();
+    if (pareto.optimal()) {
+        pareto.primalVars(sub_vars);
+    }
+}
+
+// Multi-cut: one cut per customer from the subproblem's solution,
+//     theta_j + sum_i w_ij y_i >= v_j
+// with only the locations where w_ij is nonzero
+template<typename Model>
+void FLP<Model>::addCustomerCuts(LPP &master, const vector<double> &sub_vars) {
+    int theta = data.locations + 1;
+    vector<int> indices;
+    vector<double> values;
+    for (int j = 0; j < data.customers; j++) {
+        indices = {theta + j};
+        values = {1};
+        for (int i = 0; i < data.locations; i++) {
+            double w = sub_vars[data.customers * (i + 1) + j];
+            if (w > 0) {
+                indices.push_back(i + 1);
+                values.push_back(w);
+            }
+        }
+        if (cut_pool->add(master, indices, values, sub_vars[j])) {
+            cuts++;
         }
     }
 }
 
 // Required data:
 // - Number of master problems solved
-// - Total CPU time
-// - CPU time for pricing problems
+// - Total time
+// - Time for subproblems
 // - Final master problem objective value
-void FLP::printSolution(LPP &master, LPP &sub, bool debug) {
+template<typename Model>
+void FLP<Model>::printSolution(LPP &master, double upper_bound, bool debug) {
     if (debug) {
         cout << "Solution found!\n";
-        cout << "UB: " << sub.objective() << ", "
-            << "LB: " << master.objective() << "\n";
+        cout << "UB: " << upper_bound << ", "
+            << "LB: " << master.intObjective() << "\n";
 
         cout << "z, Built fclties.: ";
-        vector<double> master_primal = master.primalVars();
+        vector<double> master_primal = master.intPrimalVars();
         prettyPrintVector(master_primal, 10);
 
-        cout << "Sub primal solution: \n";
-        vector<double> sub_primal = sub.primalVars();
-        prettyPrintVector(sub_primal, 10);
-
-        cout << "Sub dual solution: \n";
-        vector<double> sub_dual = sub.dualVars();
-        prettyPrintVector(sub_dual, 10);
+        cout << "Master problems solved: " << master_solutions << "\n";
+        cout << "Total time: " << total_time << " seconds\n";
+        cout << "Subproblem time: " << pricing_time << " seconds\n";
+        cout << "LP-relaxation masters solved: " << relaxed_solutions
+            << "\n";
+        cout << "Master time: " << master_time << " seconds\n";
+        cout << "Pareto cut time: " << pareto_time << " seconds\n";
+        cout << "Subproblems solved: " << subproblems << "\n";
+        if (closed && opts.validate) {
+            cout << "Closed-form subproblems validated: " << validations
+                << ", mismatches: " << validation_failures << "\n";
+        }
+        cout << "Branch-and-cut nodes: " << nodes << "\n";
+        cout << "Cuts: " << cuts << "\n";
+        cout << "Cuts in the master: " << cut_pool->active() << "\n";
+        cout << "Duplicate cuts rejected: " << cut_pool->duplicates << "\n";
+        cout << "Cuts dropped: " << cut_pool->dropped << ", restored: "
+            << cut_pool->restored << "\n";
 
         master.saveProblemInfo("last_master.txt");
-        sub.saveProblemInfo("last_sub.txt");
     } else {
-        cout << "Silence\n";
+        cout << title << " & "
+            << master_solutions << " & "
+            << total_time << " & "
+            << pricing_time << " & "
+            << master.intObjective() << " & "
+            << master_time << " & "
+            << cuts << " & "
+            << pareto_time << " & "
+            << subproblems << " & "
+            << nodes << " & "
+            << relaxed_solutions << " & "
+            << cut_pool->active() << "\n";
+    }
+}
+
+// Sets up the subproblem for the initial built locations. It is built
+// once, then only its objective is updated to each cycle's locations and
+// it is re-solved from its previous basis. The extreme ray LP is handled
+// the same way, once it is first needed. Only the uncapacitated
+// subproblem separates by customer, or has a closed form. The LP is still
+// built alongside the closed form to validate it.
+template<typename Model>
+void FLP<Model>::initializeSubproblems(const vector<double> &built) {
+    split = opts.sub == SubMode::customers && !Model::capacitated;
+    closed = opts.sub == SubMode::closed && !Model::capacitated;
+    // main rejects these options for the capacitated model; other callers
+    // still get a visible fallback
+    if (opts.sub != SubMode::monolithic && Model::capacitated) {
+        cout << "WARNING: Capacitated subproblem, solving it as a single "
+            "LP\n";
+    }
+    if (split) {
+        customer_subs.reset(new CustomerSubproblems(data, opts.threads));
+    } else if (closed) {
+        closed_sub.reset(new ClosedFormSubproblem(data));
+    }
+    if ((!split && !closed) || (closed && opts.validate)) {
+        sub.reset(new LPP(initializeSub(built)));
+    }
+    sub_built = built;
+    validations = 0;
+    validation_failures = 0;
+
+    // Magnanti-Wong cuts use the running average of every built vector so
+    // far as the core point, starting from all 0.5, which keeps it strictly
+    // inside the unit box
+    if (opts.pareto) {
+        pareto.reset(new LPP(initializeParetoSub()));
+    }
+    core = vector<double>(data.locations, 0.5);
+    core_points = 1;
+}
+
+// Solves the subproblem for the built locations and keeps the cut it
+// yields, to be added by addCuts. Returns the subproblem's objective, an
+// upper bound, or infinity if it is unbounded and the cut is a
+// feasibility cut.
+template<typename Model>
+double FLP<Model>::separate(const vector<double> &built, int cycle,
+        bool silent) {
+    double sub_begin = wallTime();
+    bool unbounded = false;
+    if (split) {
+        customer_subs->solve(built);
+        sub_vars = customer_subs->primalVars();
+    } else if (closed) {
+        closed_sub->solve(built);
+        sub_vars = closed_sub->primalVars();
+    } else {
+        updateSubLocations(*sub, sub_built, built);
+        sub->setConstantTerm(totalBuildCost(built));
+        sub_built = built;
+        if (!silent) {
+            cout << "About to solve subproblem for cycle " << cycle << "\n";
+            string path = "cycle" + std::to_string(cycle) + "_sub.txt";
+            sub->saveProblemInfo(path);
+        }
+
+        sub->reoptimize();
+        sub->primalVars(sub_vars);
+        unbounded = sub->unboundedPrimal();
+    }
+    pricing_time += wallTime() - sub_begin;
+    subproblems++;
+
+    if (!silent) {
+        cout << "Sub vars:\n";
+        prettyPrintVector(sub_vars, 10);
+        if (!split && !closed) {
+            vector<double> x_vals = sub->dualVars();
+            cout << "X vals:\n";
+            prettyPrintVector(x_vals, 10);
+        }
+    }
+
+    double value = numeric_limits<double>::infinity();
+    feasibility_cut = unbounded;
+    if (!unbounded) {
+        if (split) {
+            value = totalBuildCost(built) + customer_subs->objective();
+        } else if (closed) {
+            value = totalBuildCost(built) + closed_sub->objective();
+        } else {
+            value = sub->objective();
+        }
+        if (!silent) {
+            cout << "Sub is bounded, UB: " << value << "\n";
+        }
+        if (closed && opts.validate) {
+            validateClosedForm(built, value);
+        }
+        if (pareto) {
+            double pareto_begin = wallTime();
+            paretoSolution(*pareto, core, built,
+                    value - totalBuildCost(built), sub_vars);
+            pareto_time += wallTime() - pareto_begin;
+
+            core_points++;
+            for (int i = 0; i < data.locations; i++) {
+                core[i] += (built[i] - core[i]) / core_points;
+            }
+        }
+        constraint_row = constraintFromSub(sub_vars);
+        constant_term = constraintConstantFromSub(sub_vars);
+    } else {
+        if (!silent) {
+            cout << "Sub is unbounded, solving extreme ray problem\n";
+        }
+        if (!ray) {
+            ray.reset(new LPP(initializeRayGen(built, 10000000)));
+        } else {
+            updateSubLocations(*ray, ray_built, built);
+        }
+        ray_built = built;
+        ray->reoptimize();
+
+        if (!silent) {
+            cout << "Objective: " << ray->objective() << "\n";
+            vector<double> ray_primal = ray->primalVars();
+            cout << "Ray primal vars: ";
+            prettyPrintVector(ray_primal, 10);
+            vector<double> ray_dual = ray->dualVars();
+            cout << "Ray dual vars: ";
+            prettyPrintVector(ray_dual, 10);
+            string path = "cycle" + std::to_string(cycle) + "_ray.txt";
+            ray->saveProblemInfo(path);
+        }
+
+        constraint_row = constraintFromSub(ray->primalVars(), true);
+        constant_term = 0;
+    }
+
+    if (!silent) {
+        cout << "New master constraint:\n";
+        cout << "Constant " << constant_term << ";\n";
+        prettyPrintVector(constraint_row, 10);
+    }
+
+    return value;
+}
+
+// Checks the closed-form subproblem solution in sub_vars, with objective
+// value, against the LP for the same locations: both must have the same
+// objective, the solution must be feasible in the LP, and its cut must be
+// tight at built. The LP may pick another optimal solution, so the cuts
+// themselves are not compared; the closed form's has the smallest w_ij.
+template<typename Model>
+void FLP<Model>::validateClosedForm(const vector<double> &built, double value) {
+    updateSubLocations(*sub, sub_built, built);
+    sub->setConstantTerm(totalBuildCost(built));
+    sub_built = built;
+    sub->reoptimize();
+    double lp_value = sub->objective();
+    double tolerance = 1e-6 * std::max(1., abs(lp_value));
+
+    // v_j - w_ij <= c_ij, w_ij >= 0
+    bool feasible = true;
+    for (int i = 0; i < data.locations; i++) {
+        for (int j = 0; j < data.customers; j++) {
+            double w = sub_vars[data.customers * (i + 1) + j];
+            if (w < 0 || sub_vars[j] - w > data.shipCost(i, j) + tolerance) {
+                feasible = false;
+            }
+        }
+    }
+
+    // The cut is z >= constant - sum_i row[i + 1] y_i
+    vector<double> row = constraintFromSub(sub_vars);
+    double cut = constraintConstantFromSub(sub_vars);
+    for (int i = 0; i < data.locations; i++) {
+        cut -= row[i + 1] * built[i];
+    }
+
+    validations++;
+    if (abs(lp_value - value) > tolerance || !feasible
+            || abs(cut - value) > tolerance) {
+        validation_failures++;
+        cout << "ERROR: Closed-form subproblem " << value
+            << (feasible ? "" : " (infeasible)") << " with cut " << cut
+            << " differs from the LP's " << lp_value << "\n";
+    }
+}
+
+// Adds the cut found by the last call to separate to the master
+template<typename Model>
+void FLP<Model>::addCuts(LPP &master) {
+    if (multi_cut && !feasibility_cut) {
+        addCustomerCuts(master, sub_vars);
+    } else {
+        vector<int> indices;
+        vector<double> values;
+        for (size_t k = 0; k < constraint_row.size(); k++) {
+            if (constraint_row[k] != 0) {
+                indices.push_back(k);
+                values.push_back(constraint_row[k]);
+            }
+        }
+        if (cut_pool->add(master, indices, values, constant_term)) {
+            cuts++;
+        }
+    }
+}
+
+// Phase one of the two-phase decomposition: with the y_i relaxed to
+// continuous, each master is a cheap LP, and the subproblem is separated at
+// its fractional solution. Cuts at fractional points are as valid as at
+// integer ones, so they all carry over to the integer cycles. Stops once the
+// relaxation's bound meets the subproblem value, or after
+// opts.relax_cycles cycles, then makes the y_i binary again. Returns the
+// number of cycles run.
+template<typename Model>
+int FLP<Model>::solveRelaxation(LPP &master, const vector<double> &built,
+        bool silent) {
+    for (int i = 0; i < data.locations; i++) {
+        master.setBinary(i + 1, false);
+    }
+
+    vector<double> y = built;
+    vector<double> primal;
+    int cycle = 0;
+    bool restored = false;
+    double value = numeric_limits<double>::infinity();
+    while (cycle < opts.relax_cycles) {
+        if (!restored) {
+            value = separate(y, cycle, silent);
+            addCuts(master);
+        }
+        cycle++;
+
+        double master_begin = wallTime();
+        master.simplex();
+        master_time += wallTime() - master_begin;
+        relaxed_solutions++;
+        if (!master.optimal()) {
+            break;
+        }
+
+        double lower_bound = master.objective();
+        master.primalVars(primal);
+        if (!silent) {
+            cout << "Relaxed cycle " << cycle - 1 << ", UB: " << value
+                << ", LB: " << lower_bound << "\n";
+        }
+        if (value - lower_bound <= PRECISION) {
+            break;
+        }
+        restored = cut_pool->restore(master, primal) > 0;
+        if (!restored) {
+            cut_pool->age(master, primal);
+        }
+        y.assign(primal.begin() + 1, primal.begin() + 1 + data.locations);
     }
+
+    for (int i = 0; i < data.locations; i++) {
+        master.setBinary(i + 1, true);
+    }
+    return cycle;
 }
 
-void FLP::solve(bool debug) {
+template<typename Model>
+void FLP<Model>::solve(bool debug) {
     bool silent = !debug;
 
     if (!silent) {
@@ -362,36 +795,68 @@ void FLP::solve(bool debug) {
         LPP::termOut(silent);
     }
 
-    LPP master = initializeMaster();
+    // Per-customer cuts need the subproblem to separate by customer
+    multi_cut = opts.cuts == CutMode::multi && !Model::capacitated;
+    if (opts.cuts == CutMode::multi && !multi_cut) {
+        cout << "WARNING: Capacitated subproblem, adding a single cut per "
+            "cycle\n";
+    }
+    LPP master = initializeMaster(multi_cut);
 
     if (!silent) {
         cout << "Master problem initialized.\n";
         master.saveProblemInfo("first_master.txt");
     }
 
-    vector<int> initial_locations;
+    vector<double> initial_locations;
     // All 1s when capacitated
-    if (CAPACITATED) {
-        initial_locations = vector<int>(data.locations, 1);
+    if (Model::capacitated) {
+        initial_locations = vector<double>(data.locations, 1);
     } else {
-        initial_locations = vector<int>(data.locations, 0);
+        initial_locations = vector<double>(data.locations, 0);
         initial_locations[0] = 1;
     }
 
 
     master_solutions = 0;
+    relaxed_solutions = 0;
     // total_time not initialized because it's not computed incrementally
     pricing_time = 0;
+    master_time = 0;
+    pareto_time = 0;
+    cuts = 0;
+    subproblems = 0;
+    nodes = 0;
 
     double upper_bound = numeric_limits<double>::max();
     double lower_bound = numeric_limits<double>::lowest();
 
-    vector<double> constraint_constants;
-    vector<vector<double>> constraint_rows;
-
     int cycle = 0;
-    vector<int> built = initial_locations;
+    vector<double> built = initial_locations;
+    double begin = wallTime();
+
+    initializeSubproblems(built);
+    cut_pool.reset(new CutPool(opts.cut_idle));
+
+    if (opts.relax_cycles > 0) {
+        cycle = solveRelaxation(master, built, silent);
+    }
+
+    // The relaxation phase starts by separating the initial locations, so
+    // their cut is already in the master
+    bool separated = opts.relax_cycles > 0;
+
+    if (opts.single_tree) {
+        solveSingleTree(master, built, separated, silent);
+        total_time = wallTime() - begin;
+        printSolution(master, best_upper_bound, debug);
+        return;
+    }
 
+    // Set when the last master solution violates dropped cuts: they are
+    // added back and the master re-solved before separating again. Only
+    // solutions which are separated count towards dropping cuts.
+    bool restored = separated;
     while (true) {
         if (!silent) {
             cout << "=============================\n";
@@ -399,73 +864,21 @@ void FLP::solve(bool debug) {
             cout << "=============================\n";
         }
 
-        LPP sub = initializeSub(built);
-        if (!silent) {
-            cout << "About to solve subproblem for cycle " << cycle << "\n";
-            string path = "cycle" + std::to_string(cycle) + "_sub.txt";
-            sub.saveProblemInfo(path);
-        }
-
-        sub.simplex();
-        vector<double> sub_vars = sub.primalVars(); // u = (v, w)
-        vector<double> x_vals = sub.dualVars();
-
-        if (!silent) {
-            cout << "Sub vars:\n";
-            prettyPrintVector(sub_vars, 10);
-            cout << "X vals:\n";
-            prettyPrintVector(x_vals, 10);
-        }
-
-        vector<double> constraint_row;
-        double constant_term;
-
-        if (!sub.unboundedPrimal()) {
-            upper_bound = sub.objective();
-            if (!silent) {
-                cout << "Sub is bounded, UB: " << upper_bound << "\n";
-            }
-            constraint_row = constraintFromSub(sub);
-            constant_term = constraintConstantFromSub(sub);
-        } else {
-            if (!silent) {
-                cout << "Sub is unbounded, solving extreme ray problem\n";
-            }
-            LPP ray = initializeRayGen(built, 10000000);
-            ray.simplex();
-
-            if (!silent) {
-                cout << "Objective: " << ray.objective() << "\n";
-                vector<double> ray_primal = ray.primalVars();
-                cout << "Ray primal vars: ";
-                prettyPrintVector(ray_primal, 10);
-                vector<double> ray_dual = ray.dualVars();
-                cout << "Ray dual vars: ";
-                prettyPrintVector(ray_dual, 10);
-                string path = "cycle" + std::to_string(cycle) + "_ray.txt";
-                ray.saveProblemInfo(path);
-            }
-
-            constraint_row = constraintFromSub(ray, true);
-            constant_term = 0;
-        }
-
-        if (!silent) {
-            cout << "New master constraint:\n";
-            cout << "Constant " << constant_term << ";\n";
-            prettyPrintVector(constraint_row, 10);
+        if (!restored) {
+            upper_bound = separate(built, cycle, silent);
+            addCuts(master);
         }
 
-        master.addRow(LPBounds::lower, constant_term, constant_term);
-        master.addConstrRow(constraint_row);
-
         if (!silent) {
             cout << "About to solve master for cycle " << cycle << "\n";
             string path = "cycle" + std::to_string(cycle) + "_master.txt";
             master.saveProblemInfo(path);
         }
 
+        double master_begin = wallTime();
         master.integer();
+        master_time += wallTime() - master_begin;
+        master_solutions++;
         vector<double> primal = master.intPrimalVars();
 
         lower_bound = master.intObjective();
@@ -476,12 +889,18 @@ void FLP::solve(bool debug) {
         }
 
         if (upper_bound - lower_bound <= PRECISION) {
-            cout << "DONE!\n";
-            /* printSolution(master, sub, debug); */
+            total_time = wallTime() - begin;
+            printSolution(master, upper_bound, debug);
             return;
         }
 
-        vector<int> built_locations(primal.begin() + 1, primal.end());
+        restored = cut_pool->restore(master, primal) > 0;
+        if (!restored) {
+            cut_pool->age(master, primal);
+        }
+
+        vector<double> built_locations(primal.begin() + 1,
+                primal.begin() + 1 + data.locations);
 
         if (!silent) {
             cout << "Built: ";
@@ -493,3 +912,87 @@ void FLP::solve(bool debug) {
         cycle++;
     }
 }
+
+// GLPK callback for the single-tree master, see solveSingleTree
+template<typename Model>
+void FLP<Model>::rowGenCallback(glp_tree *tree, void *info) {
+    static_cast<FLP *>(info)->generateRows(tree);
+}
+
+// At every node whose LP relaxation has all y_i integral, solves the
+// subproblem for those locations and adds its cut as a lazy constraint if
+// the relaxation's z_0 underestimates the subproblem. Otherwise the node's
+// solution is a feasible solution of the full problem.
+template<typename Model>
+void FLP<Model>::generateRows(glp_tree *tree) {
+    int total;
+    glp_ios_tree_size(tree, nullptr, nullptr, &total);
+    nodes = std::max(nodes, total);
+
+    if (glp_ios_reason(tree) != GLP_IROWGEN) {
+        return;
+    }
+
+    // Dropped cuts, from the relaxation phase or from other subtrees, come
+    // back first. Rows can only be added inside the tree, so no cut is
+    // dropped there.
+    tree_master->primalVars(tree_primal);
+    if (cut_pool->restore(*tree_master, tree_primal) > 0) {
+        return;
+    }
+
+    vector<double> built(data.locations);
+    for (int i = 0; i < data.locations; i++) {
+        double y = tree_primal[i + 1];
+        if (abs(y - std::round(y)) > 1e-6) {
+            return;
+        }
+        built[i] = std::round(y);
+    }
+
+    double sub_begin = wallTime();
+    double value = separate(built, subproblems, tree_silent);
+    // separate's own time is already counted as subproblem time
+    master_time -= wallTime() - sub_begin;
+
+    if (value < best_upper_bound) {
+        best_upper_bound = value;
+    }
+    if (value > tree_primal[0] + PRECISION) {
+        addCuts(*tree_master);
+    }
+}
+
+// Single-tree branch-and-cut: after a first cut from the initial locations,
+// which bounds the LP relaxation, the master MIP is solved once, adding
+// Benders cuts lazily inside GLPK's search tree (see generateRows). With
+// separated, that cut is already in the master.
+template<typename Model>
+void FLP<Model>::solveSingleTree(LPP &master, const vector<double> &built,
+        bool separated, bool silent) {
+    best_upper_bound = numeric_limits<double>::max();
+    if (!separated) {
+        best_upper_bound = separate(built, 0, silent);
+        addCuts(master);
+    }
+
+    tree_master = &master;
+    tree_silent = silent;
+
+    double master_begin = wallTime();
+    cut_pool->setLazy(true);
+    master.integer(&FLP::rowGenCallback, this);
+    cut_pool->setLazy(false);
+    master_time += wallTime() - master_begin;
+    master_solutions++;
+
+    if (!silent) {
+        cout << "UB: " << best_upper_bound << ", "
+            << "LB: " << master.intObjective() << "\n";
+        cout << "Subproblems solved: " << subproblems << "\n";
+        cout << "Nodes: " << nodes << "\n";
+    }
+}
+
+template class FLP<Capacitated>;
+template class FLP<Uncapacitated>;
@@ -3,35 +3,106 @@
 #include <glpk.h>
 #include <ctime>
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "ClosedFormSubproblem.h"
+#include "CustomerSubproblems.h"
+#include "CutPool.h"
 #include "FLPData.h"
+#include "FLPModel.h"
 #include "LPP.h"
+#include "Options.h"
 
 using std::string;
 using std::vector;
 
+// Benders decomposition of the facility location problem, for one of the
+// model variants in FLPModel.h. Both are instantiated in FLP.cpp.
+template<typename Model>
 class FLP {
     string title;
     FLPData data;
+    Options opts;
 
     int master_solutions;
+    int relaxed_solutions;
     double total_time;
     double pricing_time;
+    double master_time;
+    double pareto_time;
+    int cuts;
+    int subproblems;
+    int nodes;
 
-    LPP initializeMaster();
-    LPP initializeSub(vector<int> built_locations);
-    LPP initializeRayGen(vector<int> built_locations, double upper_bound);
-    void updateSubLocations(LPP &sub, vector<int> built_locations);
-    void printSolution(LPP &master, LPP &sub, bool debug);
-    double totalBuildCost(vector<int> built_locations);
+    // Subproblem state, kept across cycles
+    bool split;
+    bool closed;
+    bool multi_cut;
+    std::unique_ptr<LPP> sub;
+    std::unique_ptr<CustomerSubproblems> customer_subs;
+    std::unique_ptr<ClosedFormSubproblem> closed_sub;
+    int validations;
+    int validation_failures;
+    vector<double> sub_built;
+    std::unique_ptr<LPP> ray;
+    vector<double> ray_built;
+    std::unique_ptr<LPP> pareto;
+    vector<double> core;
+    int core_points;
 
-    vector<double> constraintFromSub(LPP &sub, bool extreme_ray = 0);
-    double constraintConstantFromSub(LPP &sub);
+    // Every cut added to the master
+    std::unique_ptr<CutPool> cut_pool;
+
+    // Cut found by the last call to separate
+    vector<double> sub_vars;
+    bool feasibility_cut;
+    vector<double> constraint_row;
+    double constant_term;
+
+    // Single-tree search state, for the GLPK callback
+    LPP *tree_master;
+    bool tree_silent;
+    vector<double> tree_primal;
+    double best_upper_bound;
+
+    LPP initializeMaster(bool multi_cut);
+    LPP initializeSub(const vector<double> &built_locations);
+    LPP initializeRayGen(const vector<double> &built_locations,
+            double upper_bound);
+    void updateSubLocations(LPP &sub, const vector<double> &previous,
+            const vector<double> &built);
+    template<typename T>
+    double betaObjective(const vector<T> &built_locations);
+    void setSubObjective(LPP &sub, const vector<double> &y);
+    LPP initializeParetoSub();
+    void paretoSolution(LPP &pareto, const vector<double> &core,
+            const vector<double> &built, double sub_value,
+            vector<double> &sub_vars);
+    void printSolution(LPP &master, double upper_bound, bool debug);
+    double totalBuildCost(const vector<double> &built_locations);
+
+    vector<double> constraintFromSub(const vector<double> &sub_vars,
+            bool extreme_ray = 0);
+    double constraintConstantFromSub(const vector<double> &sub_vars);
+    void addCustomerCuts(LPP &master, const vector<double> &sub_vars);
+
+    void initializeSubproblems(const vector<double> &built);
+    double separate(const vector<double> &built, int cycle, bool silent);
+    void validateClosedForm(const vector<double> &built, double value);
+    void addCuts(LPP &master);
+
+    int solveRelaxation(LPP &master, const vector<double> &built,
+            bool silent);
+
+    static void rowGenCallback(glp_tree *tree, void *info);
+    void generateRows(glp_tree *tree);
+    void solveSingleTree(LPP &master, const vector<double> &built,
+            bool separated, bool silent);
 
     public:
-        FLP(string title, FLPData pd);
+        FLP(string title, FLPData pd, Options opts = Options());
         void printProblemData();
         void solve(bool debug);
 };
@@ -10,5 +10,30 @@ struct FLPData {
     vector<int> supplies; // per location
     vector<double> build_costs; // per location
     vector<int> demands; // per customer
-    vector<vector<double>> ship_costs; // per location, per customer
+
+    // Row-major, one row per location with one entry per customer
+    vector<double> ship_costs;
+    // Ship costs scaled by the customer's demand, as in the capacitated
+    // model. Empty until scaleCosts is called.
+    vector<double> demand_costs;
+
+    double shipCost(int i, int j) const {
+        return ship_costs[i * customers + j];
+    }
+
+    double demandCost(int i, int j) const {
+        return demand_costs[i * customers + j];
+    }
+
+    // Fills demand_costs from ship_costs and demands
+    void scaleCosts() {
+        demand_costs.resize(ship_costs.size());
+        for (int i = 0; i < locations; i++) {
+            const double *ship = &ship_costs[i * customers];
+            double *scaled = &demand_costs[i * customers];
+            for (int j = 0; j < customers; j++) {
+                scaled[j] = ship[j] * demands[j];
+            }
+        }
+    }
 };
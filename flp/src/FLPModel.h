@@ -0,0 +1,25 @@
+#pragma once
+
+#include "FLPData.h"
+
+// Model variants, given to FLP as its template parameter, so that each one
+// is compiled with its own column layout and without branching on it.
+// capacitated: the subproblem has the supply duals alpha_i, one per
+// location, and beta after the v_j and w_ij columns, and the master has a
+// total capacity row.
+// cost: the coefficient of customer j at location i in the subproblem.
+struct Capacitated {
+    static const bool capacitated = true;
+
+    static double cost(const FLPData &data, int i, int j) {
+        return data.demandCost(i, j);
+    }
+};
+
+struct Uncapacitated {
+    static const bool capacitated = false;
+
+    static double cost(const FLPData &data, int i, int j) {
+        return data.shipCost(i, j);
+    }
+};
@@ -0,0 +1,38 @@
+#include "FLPReader.h"
+#include "Scanner.h"
+
+bool readFLPData(const string &path, FLPData &data) {
+    Scanner scanner(path);
+    if (!scanner.readInt(data.locations) || !scanner.readInt(data.customers)
+            || data.locations < 0 || data.customers < 0) {
+        return false;
+    }
+
+    data.supplies.resize(data.locations);
+    data.build_costs.resize(data.locations);
+    for (int i = 0; i < data.locations; i++) {
+        if (!scanner.readInt(data.supplies[i])
+                || !scanner.readDouble(data.build_costs[i])) {
+            return false;
+        }
+    }
+
+    data.demands.resize(data.customers);
+    data.ship_costs.resize(static_cast<size_t>(data.locations)
+        * data.customers);
+
+    // For consistency, i always indexes locations, and j, customers.
+    for (int j = 0; j < data.customers; j++) {
+        if (!scanner.readInt(data.demands[j])) {
+            return false;
+        }
+        double *ship = &data.ship_costs[j];
+        for (int i = 0; i < data.locations; i++) {
+            if (!scanner.readDouble(ship[i * data.customers])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
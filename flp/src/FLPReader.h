@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+#include "FLPData.h"
+
+using std::string;
+
+// Reads an instance from a memory-mapped file: the number of locations and
+// customers, the supply and build cost of each location, then each
+// customer's demand followed by its ship cost from every location. Returns
+// false if the file could not be read or is malformed.
+bool readFLPData(const string &path, FLPData &data);
@@ -1,9 +1,11 @@
 #include "LPP.h"
 
 #include <glpk.h>
+#include <algorithm>
 #include <cassert>
 #include <vector>
 #include <iostream>
+#include <utility>
 
 using std::vector;
 
@@ -13,8 +15,18 @@ LPP::LPP(ObjDir d)
     glp_set_obj_dir(lp, static_cast<int>(d));
 }
 
+LPP::LPP(LPP &&other)
+    : lp(other.lp), rows(other.rows), cols(other.cols),
+      constr_rows(other.constr_rows), constr_cols(other.constr_cols),
+      scratch_indices(std::move(other.scratch_indices)),
+      scratch_coef(std::move(other.scratch_coef)) {
+    other.lp = nullptr;
+}
+
 LPP::~LPP() {
-    glp_delete_prob(lp);
+    if (lp != nullptr) {
+        glp_delete_prob(lp);
+    }
     // no glp_free_env, there may be other LPP objects
 }
 
@@ -22,9 +34,16 @@ void LPP::setConstantTerm(double value) {
     glp_set_obj_coef(lp, 0, value);
 }
 
+void LPP::setObjCoef(int col, double value) {
+    assert(col < cols and col >= 0);
+    glp_set_obj_coef(lp, col + 1, value);
+}
+
+// The row's index comes from GLPK: inside glp_intopt, rows added in one
+// subtree are deleted when the search leaves it
 void LPP::addRow(LPBounds bounds, double from, double to) {
-    glp_add_rows(lp, 1);
-    rows++;
+    rows = glp_add_rows(lp, 1);
+    constr_rows = std::min(constr_rows, rows - 1);
     glp_set_row_bnds(lp, rows, static_cast<int>(bounds), from, to);
 }
 
@@ -40,12 +59,46 @@ void LPP::addBinaryCol(double obj) {
     glp_set_col_kind(lp, cols, GLP_BV);
 }
 
+// Switches a column between binary and continuous. A column made continuous
+// keeps the [0, 1] bounds of a binary one.
+void LPP::setBinary(int col, bool binary) {
+    assert(col < cols and col >= 0);
+    glp_set_col_kind(lp, col + 1, binary ? GLP_BV : GLP_CV);
+}
+
 
 void LPP::setRowBounds(int row, LPBounds bounds, double from, double to) {
     assert(row < rows and row >= 0);
     glp_set_row_bnds(lp, row + 1, static_cast<int>(bounds), from, to);
 }
 
+// Deletes rows (0-based), renumbering the ones after them. Deleting only
+// basic rows leaves a valid basis; otherwise a new one is built.
+void LPP::deleteRows(const vector<int> &deleted) {
+    int len = deleted.size();
+    if (len == 0) {
+        return;
+    }
+    scratch_indices.resize(len + 1);
+    bool basic = true;
+    for (int k = 0; k < len; k++) {
+        assert(deleted[k] < rows and deleted[k] >= 0);
+        scratch_indices[k + 1] = deleted[k] + 1;
+        basic = basic && glp_get_row_stat(lp, deleted[k] + 1) == GLP_BS;
+    }
+
+    glp_del_rows(lp, len, scratch_indices.data());
+    rows -= len;
+    constr_rows -= len;
+    if (!basic) {
+        glp_adv_basis(lp, 0);
+    }
+}
+
+int LPP::rowCount() {
+    return rows;
+}
+
 
 void LPP::addConstrCol(vector<double> col) {
     if (constr_rows == 0) {
@@ -68,6 +121,7 @@ void LPP::addConstrCol(vector<double> col) {
     glp_set_mat_col(lp, constr_cols, constr_rows, indices, coef);
 
     delete[] indices;
+    delete[] coef;
 }
 
 void LPP::addConstrRow(vector<double> row) {
@@ -91,6 +145,50 @@ void LPP::addConstrRow(vector<double> row) {
     glp_set_mat_row(lp, constr_rows, constr_cols, indices, coef);
 
     delete[] indices;
+    delete[] coef;
+}
+
+// Sparse version of addConstrRow: values[k] is the coefficient of column
+// indices[k] (0-based), and every other coefficient is zero
+void LPP::addConstrRow(const vector<int> &indices,
+        const vector<double> &values) {
+    if (constr_cols == 0) {
+        constr_cols = cols;
+    }
+    assert(indices.size() == values.size());
+
+    int len = indices.size();
+    scratch_indices.resize(len + 1);
+    scratch_coef.resize(len + 1);
+    for (int k = 0; k < len; k++) {
+        assert(indices[k] < constr_cols and indices[k] >= 0);
+        scratch_indices[k + 1] = indices[k] + 1;
+        scratch_coef[k + 1] = values[k];
+    }
+
+    constr_rows++;
+    glp_set_mat_row(lp, constr_rows, len, scratch_indices.data(),
+            scratch_coef.data());
+}
+
+// Replaces every coefficient of an existing row (0-based) with the sparse
+// values given, as in the sparse addConstrRow
+void LPP::setConstrRow(int row, const vector<int> &indices,
+        const vector<double> &values) {
+    assert(row < constr_rows and row >= 0);
+    assert(indices.size() == values.size());
+
+    int len = indices.size();
+    scratch_indices.resize(len + 1);
+    scratch_coef.resize(len + 1);
+    for (int k = 0; k < len; k++) {
+        assert(indices[k] < constr_cols and indices[k] >= 0);
+        scratch_indices[k + 1] = indices[k] + 1;
+        scratch_coef[k + 1] = values[k];
+    }
+
+    glp_set_mat_row(lp, row + 1, len, scratch_indices.data(),
+            scratch_coef.data());
 }
 
 void LPP::loadMatrix(vector<vector<double>> m) {
@@ -133,6 +231,25 @@ void LPP::simplex() {
     assert(ret == 0);
 }
 
+// Re-solves with the primal simplex, starting from the current basis, which
+// stays primal feasible when only objective coefficients have changed
+void LPP::reoptimize() {
+    glp_smcp params;
+    glp_init_smcp(&params);
+    params.msg_lev = GLP_MSG_ERR;
+    params.meth = GLP_PRIMAL;
+    params.presolve = GLP_OFF;
+
+    int err = glp_simplex(lp, &params);
+    if (err == GLP_EBADB || err == GLP_ESING || err == GLP_ECOND) {
+        // The warm-start basis is invalid, singular or ill-conditioned:
+        // restart from a crash basis
+        glp_adv_basis(lp, 0);
+        err = glp_simplex(lp, &params);
+    }
+    assert(err == 0);
+}
+
 double LPP::objective() {
     return glp_get_obj_val(lp);
 }
@@ -145,6 +262,14 @@ vector<double> LPP::primalVars() {
     return out;
 }
 
+// Same as primalVars, reusing out's storage
+void LPP::primalVars(vector<double> &out) {
+    out.resize(cols);
+    for (int j = 1; j <= cols; j++) { // 1-based
+        out[j - 1] = glp_get_col_prim(lp, j);
+    }
+}
+
 vector<double> LPP::dualVars() {
     vector<double> out;
     for (int i = 1; i <= rows; i++) { // 1-based
@@ -158,6 +283,10 @@ bool LPP::unboundedPrimal() {
     return glp_get_dual_stat(lp) == GLP_NOFEAS;
 }
 
+bool LPP::optimal() {
+    return glp_get_status(lp) == GLP_OPT;
+}
+
 void LPP::integer() {
     glp_iocp params;
     glp_init_iocp(&params);
@@ -166,6 +295,37 @@ void LPP::integer() {
     assert(err == 0);
 }
 
+// Branch-and-cut calling back on every search event, so that rows can be
+// added as lazy constraints at GLP_IROWGEN. The callback sees the original
+// problem only with presolve off, which in turn needs the LP relaxation
+// solved beforehand.
+void LPP::integer(void (*callback)(glp_tree *, void *), void *info) {
+    glp_smcp relaxation;
+    glp_init_smcp(&relaxation);
+    relaxation.msg_lev = GLP_MSG_ERR;
+    relaxation.presolve = GLP_OFF;
+    int err = glp_simplex(lp, &relaxation);
+    assert(err == 0);
+
+    glp_iocp params;
+    glp_init_iocp(&params);
+    params.presolve = GLP_OFF;
+    // Every incumbent must come from a node's LP relaxation, which the
+    // callback sees at GLP_IROWGEN. A heuristic solution would skip it, and
+    // could be accepted with z_0 below its true subproblem cost, pruning
+    // the real optimum.
+    params.sr_heur = GLP_OFF;
+    params.fp_heur = GLP_OFF;
+    params.ps_heur = GLP_OFF;
+    params.cb_func = callback;
+    params.cb_info = info;
+    err = glp_intopt(lp, &params);
+    assert(err == 0);
+
+    // The search has deleted every row added by the callback
+    rows = constr_rows = glp_get_num_rows(lp);
+}
+
 double LPP::intObjective() {
     return glp_mip_obj_val(lp);
 }
@@ -25,30 +25,50 @@ class LPP {
     int rows, cols;
     int constr_rows, constr_cols;
 
+    // Scratch arrays for GLPK's 1-based sparse vectors, reused across calls
+    vector<int> scratch_indices;
+    vector<double> scratch_coef;
+
     public:
         LPP(ObjDir d);
+        LPP(LPP &&other);
         ~LPP();
 
+        LPP(const LPP &) = delete;
+        LPP &operator=(const LPP &) = delete;
+
         void setConstantTerm(double value);
+        void setObjCoef(int col, double value);
 
         void addRow(LPBounds bounds, double from, double to);
         void addCol(double obj, LPBounds bounds, double from, double to);
         void addBinaryCol(double obj);
+        void setBinary(int col, bool binary);
 
         void setRowBounds(int row, LPBounds bounds, double from, double to);
+        void deleteRows(const vector<int> &rows);
+        int rowCount();
 
         void addConstrCol(vector<double> col);
         void addConstrRow(vector<double> col);
+        void addConstrRow(const vector<int> &indices,
+                const vector<double> &values);
+        void setConstrRow(int row, const vector<int> &indices,
+                const vector<double> &values);
         void loadMatrix(vector<vector<double>> m);
 
         void simplex();
+        void reoptimize();
 
         double objective();
         vector<double> primalVars();
+        void primalVars(vector<double> &out);
         vector<double> dualVars();
         bool unboundedPrimal();
+        bool optimal();
 
         void integer();
+        void integer(void (*callback)(glp_tree *, void *), void *info);
         double intObjective();
         vector<double> intPrimalVars();
 
@@ -0,0 +1,47 @@
+#pragma once
+
+enum class ModelKind {
+    capacitated,  // locations have supplies (see FLPModel.h)
+    uncapacitated
+};
+
+enum class SubMode {
+    monolithic, // one LP over every location-customer pair
+    customers,  // one LP per customer, solved in parallel (uncapacitated)
+    closed      // closed form from sorted costs, no LP (uncapacitated)
+};
+
+enum class CutMode {
+    single, // one aggregated optimality cut per cycle
+    multi   // one optimality cut per customer (uncapacitated)
+};
+
+// Algorithm settings for the Benders decomposition, set from the command
+// line
+struct Options {
+    ModelKind model = ModelKind::capacitated;
+    SubMode sub = SubMode::monolithic;
+    CutMode cuts = CutMode::single;
+
+    // Strengthen optimality cuts with the Magnanti-Wong LP around a core
+    // point, the average of the built vectors so far
+    bool pareto = false;
+
+    // Solve the master MIP once, adding cuts lazily from a GLPK callback at
+    // every integer node, instead of re-solving it after every cut
+    bool single_tree = false;
+
+    // Cycles of the LP-relaxation phase, run before the integer cycles with
+    // y relaxed to [0, 1]; 0 skips it
+    int relax_cycles = 0;
+
+    // Master solutions a cut may stay slack for before it is dropped from
+    // the master, kept in the cut pool; 0 keeps every cut
+    int cut_idle = 0;
+
+    // Worker threads for the per-customer subproblems
+    int threads = 1;
+
+    // Check every closed-form subproblem solution against the LP
+    bool validate = false;
+};
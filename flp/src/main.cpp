@@ -1,79 +1,219 @@
 #include <iostream>
-#include <fstream>
 #include <string>
 #include <cstring>
+#include <cstdlib>
 #include <vector>
 
+#include <algorithm>
+#include <thread>
+#include <utility>
+
 #include "FLPData.h"
+#include "FLPReader.h"
 #include "FLP.h"
+#include "Options.h"
 
 using std::strcmp;
 using std::string;
 using std::vector;
 using std::cout;
 
-FLPData readProblemData(std::ifstream &file) {
-    FLPData data;
-
-    file >> data.locations >> data.customers;
-
-    for (int i = 0; i < data.locations; i++) {
-        int supply;
-        double build_cost;
-        file >> supply >> build_cost;
-        data.supplies.push_back(supply);
-        data.build_costs.push_back(build_cost);
-    }
-
-    data.ship_costs = vector<vector<double>>(data.locations, vector<double>{});
-
-    // For consistency, i always indexes locations, and j, customers.
-    for (int j = 0; j < data.customers; j++) {
-        int demand;
-        file >> demand;
-        data.demands.push_back(demand);
-
-        for (int i = 0; i < data.locations; i++) {
-            double ship_cost;
-            file >> ship_cost;
-            data.ship_costs[i].push_back(ship_cost);
-        }
+// Solves with the model variant fixed at compile time
+template<typename Model>
+void solveModel(const string &title, FLPData data, bool debug,
+        Options opts) {
+    FLP<Model> flp(title, std::move(data), opts);
+    if (debug) {
+        flp.printProblemData();
     }
-
-    return data;
+    flp.solve(debug);
 }
 
-void singleProblem(const char *path, bool debug) {
+void singleProblem(const char *path, bool debug, Options opts) {
     if (debug) {
         string title = "Input file: ";
         title += string(path);
         cout << title << "\n";
     }
 
-    std::ifstream file(path);
-    FLPData data = readProblemData(file);
+    FLPData data;
+    if (!readFLPData(path, data)) {
+        cout << "ERROR: Could not read " << path << "\n";
+        return;
+    }
 
     if (debug) {
         cout << "Read!\n";
     }
 
-    string filename(std::strrchr(path, '/') + 1);
+    const char *slash = std::strrchr(path, '/');
+    string filename(slash == nullptr ? path : slash + 1);
 
-    FLP flp(filename, data);
-    if (debug) {
-        flp.printProblemData();
+    if (opts.model == ModelKind::capacitated) {
+        solveModel<Capacitated>(filename, std::move(data), debug, opts);
+    } else {
+        solveModel<Uncapacitated>(filename, std::move(data), debug,
+                opts);
     }
-    flp.solve(debug);
 }
 
-int main(int argc, char *argv[]) {
-    if (argc == 2) {
-        singleProblem(argv[1], false);
-    } else if (argc == 3) {
-        singleProblem(argv[1], true);
+// Parses a positive integer option value
+bool parsePositive(const string &value, int &out) {
+    char *end;
+    long parsed = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || parsed <= 0) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+// Checks the options which only apply to the uncapacitated model, printing
+// an error for the first one set with the capacitated model. Its subproblem
+// ties every customer together through the supply duals, so it doesn't
+// separate by customer, have a closed form, nor give one cut per customer.
+bool checkModelOptions(const Options &opts) {
+    if (opts.model != ModelKind::capacitated) {
+        return true;
+    }
+    if (opts.sub == SubMode::customers) {
+        cout << "ERROR: --sub=customers needs --model=uncapacitated\n";
+        return false;
+    }
+    if (opts.sub == SubMode::closed) {
+        cout << "ERROR: --sub=closed needs --model=uncapacitated\n";
+        return false;
+    }
+    if (opts.cuts == CutMode::multi) {
+        cout << "ERROR: --cuts=multi needs --model=uncapacitated\n";
+        return false;
+    }
+    return true;
+}
+
+// Parses a single "--name=value" argument into opts. Returns false if the
+// option is unknown or its value is invalid.
+bool parseOption(const string &arg, Options &opts) {
+    size_t eq = arg.find('=');
+    string name = arg.substr(2, eq == string::npos ? string::npos : eq - 2);
+    string value = eq == string::npos ? "" : arg.substr(eq + 1);
+
+    if (name == "model") {
+        if (value == "capacitated") {
+            opts.model = ModelKind::capacitated;
+        } else if (value == "uncapacitated") {
+            opts.model = ModelKind::uncapacitated;
+        } else {
+            return false;
+        }
+    } else if (name == "sub") {
+        if (value == "monolithic") {
+            opts.sub = SubMode::monolithic;
+        } else if (value == "customers") {
+            opts.sub = SubMode::customers;
+        } else if (value == "closed") {
+            opts.sub = SubMode::closed;
+        } else {
+            return false;
+        }
+    } else if (name == "cuts") {
+        if (value == "single") {
+            opts.cuts = CutMode::single;
+        } else if (value == "multi") {
+            opts.cuts = CutMode::multi;
+        } else {
+            return false;
+        }
+    } else if (name == "pareto" && value.empty()) {
+        opts.pareto = true;
+    } else if (name == "validate" && value.empty()) {
+        opts.validate = true;
+    } else if (name == "single-tree" && value.empty()) {
+        opts.single_tree = true;
+    } else if (name == "relax") {
+        return parsePositive(value, opts.relax_cycles);
+    } else if (name == "drop-cuts") {
+        return parsePositive(value, opts.cut_idle);
+    } else if (name == "threads") {
+        return parsePositive(value, opts.threads);
     } else {
-        cout << "ERROR: Bad input format\n"
-            << "Format: ./flp <input_file> [debug]\n";
+        return false;
+    }
+    return true;
+}
+
+void printUsage() {
+    cout << "Format: ./flp <input_file> [debug] [options]\n"
+        << "Options:\n"
+        << "  --model=capacitated|uncapacitated\n"
+        << "                               model to solve (default: "
+           "capacitated)\n"
+        << "  --sub=monolithic|customers|closed\n"
+        << "                               solve the subproblem as one LP, "
+           "as one LP per\n"
+        << "                               customer in parallel, or in "
+           "closed form from\n"
+        << "                               sorted costs (the last two "
+           "uncapacitated only;\n"
+        << "                               default: monolithic)\n"
+        << "  --validate                   check closed-form subproblems "
+           "against the LP\n"
+        << "  --cuts=single|multi          add one aggregated cut per "
+           "cycle, or one per\n"
+        << "                               customer (uncapacitated only; "
+           "default: single)\n"
+        << "  --pareto                     strengthen optimality cuts "
+           "with Magnanti-Wong\n"
+        << "                               Pareto-optimal duals\n"
+        << "  --drop-cuts=n                drop a cut from the master once "
+           "it has been\n"
+        << "                               slack for n master solutions "
+           "in a row, adding\n"
+        << "                               it back when violated (default: "
+           "keep every cut)\n"
+        << "  --single-tree                solve the master MIP once, "
+           "adding cuts from a\n"
+        << "                               branch-and-cut callback\n"
+        << "  --relax=n                    first run up to n cycles with "
+           "the master's\n"
+        << "                               locations relaxed to an LP\n"
+        << "  --threads=n                  worker threads for per-customer "
+           "subproblems\n"
+        << "                               (default: all cores)\n";
+}
+
+int main(int argc, char *argv[]) {
+    // Options may appear anywhere; the first other argument is the input
+    // file, and any argument after it turns on debug output
+    const char *path = nullptr;
+    bool debug = false;
+    Options opts;
+    opts.threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int a = 1; a < argc; a++) {
+        string arg(argv[a]);
+        if (arg.compare(0, 2, "--") == 0) {
+            if (!parseOption(arg, opts)) {
+                cout << "ERROR: Bad option " << arg << "\n";
+                printUsage();
+                return 0;
+            }
+        } else if (path == nullptr) {
+            path = argv[a];
+        } else {
+            debug = true;
+        }
     }
+
+    if (path == nullptr) {
+        cout << "ERROR: Bad input format\n";
+        printUsage();
+        return 0;
+    }
+
+    if (!checkModelOptions(opts)) {
+        return 0;
+    }
+
+    singleProblem(path, debug, opts);
     return 0;
 }